@@ -0,0 +1,92 @@
+/**
+ * Scheduling algorithms beyond the eight in scheduler.h. scheduler() accepts
+ * these too, but the simulator only ever asks for the originals, so setting
+ * the SCHED_ALGORITHM environment variable to one of the names below makes
+ * scheduler() use that algorithm instead of the one it was given. That only
+ * happens in the default context (see context.h), the one the simulator
+ * runs in; the in-process tools refuse to run with it set rather than
+ * report one algorithm's results under another's name.
+ */
+#ifndef __ALGORITHMS_H
+#define __ALGORITHMS_H
+
+#include "scheduler.h"
+
+enum extra_algorithm {
+  MULTILEVEL_FEEDBACK_QUEUE = PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST + 1,
+  COMPLETELY_FAIR,
+  EARLIEST_DEADLINE_FIRST,
+  RATE_MONOTONIC,
+  ALGORITHM_COUNT
+};
+
+/**
+ * Names match the simulator's command line flags without the leading "--",
+ * e.g. "rr" or "p-srtf"; extra algorithms are "mlfq", "cfs", "edf" and "rm".
+ */
+const char *algorithm_name(int algorithm);
+
+/**
+ * Algorithm called NAME, or -1 if there is none.
+ */
+int algorithm_by_name(const char *name);
+
+/**
+ * Optional aging for NON_PREEMPTIVE_PRIORITY and PREEMPTIVE_PRIORITY: a ready
+ * thread's effective priority improves by one level for every INTERVAL ticks
+ * it has waited, so low priority threads cannot starve, on one CPU or many
+ * (see smp.h). On one CPU a PREEMPTIVE_PRIORITY thread keeps the level it
+ * waited its way up to until it leaves the CPU. 0 (the default) turns aging
+ * off. Without a call the SCHED_AGING environment variable is used.
+ */
+void set_aging(unsigned int interval);
+
+/**
+ * Real-time policies give each thread a relative deadline, and period, of 
+ * FACTOR times thread_t::length, so its deadline is its arrival time plus 
+ * that and its CPU utilization is 1/FACTOR. EARLIEST_DEADLINE_FIRST runs the
+ * earliest absolute deadline, RATE_MONOTONIC the shortest period, both 
+ * preemptively. sys_exec() admits a thread only if the utilization of the
+ * admitted threads still running stays within the policy's bound (1 for EDF,
+ * n(2^(1/n) - 1) for RM); the rest run in the background behind every 
+ * admitted thread. Default FACTOR is 4, or the SCHED_DEADLINE_FACTOR 
+ * environment variable without a call.
+ */
+void set_deadline_factor(unsigned int factor);
+
+/**
+ * Preemption heuristic: a running thread with no more than TICKS of CPU
+ * left is let finish rather than rotated out by ROUND_ROBIN or preempted by
+ * PREEMPTIVE_PRIORITY, the preemptive shortest job and remaining time
+ * policies, the real-time ones or COMPLETELY_FAIR, on the reasoning that a
+ * switch would cost about that much. Nothing charges for a switch, neither
+ * the simulator nor the engine by default (see engine_switch_cost() in
+ * tools/engine.h), so this only changes which switches are made. A thread
+ * held over its quantum this way is rotated out as soon as it is worth it.
+ * 0 (the default) preempts whenever the policy says to. Without a call the
+ * SCHED_SWITCH_COST environment variable is used.
+ */
+void set_switch_cost(unsigned int ticks);
+
+enum quantum_mode {
+  QUANTUM_FIXED,
+  QUANTUM_GLOBAL,
+  QUANTUM_PER_THREAD
+};
+
+/**
+ * How ROUND_ROBIN picks quanta. QUANTUM_FIXED (the default) always uses
+ * scheduler()'s QUANTUM. The adaptive modes measure every CPU burst, from
+ * dispatch to sys_read(), sys_write() or sys_exit() however many quanta it
+ * took, into a moving average weighting the newest burst 1/4 and starting
+ * at QUANTUM. QUANTUM_GLOBAL gives every thread the average over all of
+ * them, QUANTUM_PER_THREAD each thread its own, also starting at QUANTUM.
+ * Quanta are the average rounded up, kept within 1 and 8 times QUANTUM,
+ * and a thread gets a new one each time it is queued, or on more than one
+ * CPU (see smp.h) each time it is dispatched. Without a call the
+ * SCHED_QUANTUM environment variable is used: "fixed", "global" or
+ * "thread".
+ */
+void set_quantum_mode(enum quantum_mode mode);
+
+#endif // __ALGORITHMS_H
@@ -0,0 +1,42 @@
+/**
+ * Scheduler contexts. A context owns everything one simulation needs: the
+ * ready queues and the pool their nodes come from, the thread table, the 
+ * running totals, and the set_cpus(), set_aging() and set_deadline_factor()
+ * settings. The callbacks in scheduler.h, and everything in monitor.h and 
+ * smp.h, work on the calling OS thread's current context, so independent 
+ * simulations can run on different OS threads at once, or take turns on one
+ * by switching contexts between callbacks.
+ * 
+ * OS threads that never call context_use() share one default context, which
+ * is all the simulator needs.
+ */
+#ifndef __CONTEXT_H
+#define __CONTEXT_H
+
+typedef struct context context_t;
+
+/**
+ * New, empty context. It only becomes current through context_use().
+ */
+context_t *context_create();
+
+/**
+ * Make CTX the calling OS thread's current context, or the default one if 
+ * CTX is NULL.
+ */
+void context_use(context_t *ctx);
+
+/**
+ * Forget the threads, totals and queued threads of CTX's last simulation, 
+ * keeping its settings and the queue and table storage for the next one.
+ * scheduler() does this to the current context before every simulation.
+ */
+void context_reset(context_t *ctx);
+
+/**
+ * Free CTX and everything it owns. If CTX is current, the default context
+ * takes its place; destroying the default context just empties it.
+ */
+void context_destroy(context_t *ctx);
+
+#endif // __CONTEXT_H
@@ -0,0 +1,36 @@
+/**
+ * See counters.h for details.
+ */
+#include <stdio.h>
+#include "counters.h"
+
+//a histogram as a JSON array, without its trailing empty buckets
+static void histogram(FILE *file, const char *name, const unsigned long *hist)
+{
+  int last = COUNTER_BUCKETS - 1;
+  while(last > 0 && hist[last] == 0)
+  {
+    last--;
+  }
+  fprintf(file, ",\"%s\":[", name);
+  for(int b = 0; b <= last; b++)
+  {
+    fprintf(file, b ? ",%lu" : "%lu", hist[b]);
+  }
+  fprintf(file, "]");
+}
+
+void counters_write(FILE *file, const counters_t *c, const char *algorithm, int quantum,
+                    unsigned int threads)
+{
+  fprintf(file, "{\"algorithm\":\"%s\",\"quantum\":%d,\"threads\":%u", algorithm, quantum, threads);
+  fprintf(file, ",\"ticks\":%lu,\"dispatches\":%lu,\"idle_dispatches\":%lu,\"switches\":%lu,\"elided\":%lu",
+          c->ticks, c->dispatches, c->idle_dispatches, c->switches, c->elided);
+  fprintf(file, ",\"preemptions\":%lu,\"rotations\":%lu,\"io_waits\":%lu,\"io_ticks\":%lu,\"idle_ticks\":%lu",
+          c->preemptions, c->rotations, c->io_waits, c->io_ticks, c->idle_ticks);
+  fprintf(file, ",\"ready_max\":%lu,\"ready_mean\":%.3f", c->ready_max,
+          c->ticks ? (double)c->ready_sum / c->ticks : 0);
+  histogram(file, "ready_hist", c->ready_hist);
+  histogram(file, "io_hist", c->io_hist);
+  fprintf(file, "}\n");
+}
@@ -0,0 +1,57 @@
+/**
+ * Scheduler event counters. In a build with -DINSTRUMENT (see make
+ * scheduler-instrumented) every simulation counts what the scheduler did,
+ * with one increment or so per event, and stats() appends the counts as one
+ * line of JSON to the file set with set_counters(). Without -DINSTRUMENT
+ * none of it is compiled in and set_counters() does nothing.
+ *
+ * Histograms have power of two buckets: bucket 0 counts zeros and bucket
+ * k > 0 counts values in [2^(k-1), 2^k); the last also takes anything larger.
+ */
+#ifndef __COUNTERS_H
+#define __COUNTERS_H
+
+#include <stdio.h>
+
+#define COUNTER_BUCKETS 24
+
+typedef struct __counters_t {
+  unsigned long ticks;           // sim_ready() calls
+  unsigned long dispatches;      // sim_dispatch() of a thread
+  unsigned long idle_dispatches; // sim_dispatch(NULL)
+  unsigned long switches;        // Dispatches replacing a thread still on the CPU
+  unsigned long elided;          // Dispatches of the thread already on the CPU, never made
+  unsigned long preemptions;     // Running threads put back for a better one
+  unsigned long rotations;       // Running threads put back at the end of their quantum
+  unsigned long io_waits;        // sys_read() and sys_write() calls
+  unsigned long io_ticks;        // sys_read()/sys_write() to io_complete(), summed
+  unsigned long idle_ticks;      // CPU ticks with nothing running, per CPU
+  unsigned long ready_max;       // Longest ready queue at a sim_ready()
+  unsigned long ready_sum;       // Ready queue length at every sim_ready(), summed
+  unsigned long ready_hist[COUNTER_BUCKETS];    // Ready queue length at every sim_ready()
+  unsigned long io_hist[COUNTER_BUCKETS];       // Ticks of every I/O wait
+} counters_t;
+
+/**
+ * Append the next simulations' counters to the file at PATH; NULL stops.
+ * Without a call the SCHED_COUNTERS environment variable is used.
+ */
+void set_counters(const char *path);
+
+/**
+ * Histogram bucket of V.
+ */
+static inline unsigned int counter_bucket(unsigned long v)
+{
+  unsigned int b = v ? 64 - __builtin_clzl(v) : 0;
+  return b < COUNTER_BUCKETS ? b : COUNTER_BUCKETS - 1;
+}
+
+/**
+ * Write C to FILE as one line of JSON, labelled with the simulation's
+ * ALGORITHM name, QUANTUM (-1 for none) and THREADS.
+ */
+void counters_write(FILE *file, const counters_t *c, const char *algorithm, int quantum,
+                    unsigned int threads);
+
+#endif // __COUNTERS_H
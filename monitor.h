@@ -0,0 +1,145 @@
+/**
+ * Monitoring interface for a running scheduler simulation. Unlike stats(), 
+ * which is meant to be called once the simulation is over, everything here
+ * is cheap enough to call from any callback while the simulation runs.
+ */
+#ifndef __MONITOR_H
+#define __MONITOR_H
+
+/**
+ * Running totals as of the current sim_time(). Sums and means only cover 
+ * threads that have exited, since turnaround is not known before then.
+ */
+typedef struct __snapshot_t {
+  unsigned int time;
+  unsigned int thread_count;     // Threads seen by sys_exec() so far
+  unsigned int finished;         // Threads seen by sys_exit() so far
+  unsigned long turnaround_sum;
+  unsigned long waiting_sum;
+  double mean_turnaround;
+  double mean_waiting;
+  unsigned int max_waiting;
+} snapshot_t;
+
+/**
+ * Fill in SNAP from the running totals, O(1).
+ */
+void snapshot(snapshot_t *snap);
+
+/**
+ * Waiting time at or below which PERCENT of exited threads fall, e.g. 99 for
+ * the p99 tail. O(n) in the number of exited threads.
+ */
+unsigned int waiting_percentile(double percent);
+
+/**
+ * Per-thread results, as in stats_t plus CPU time received and fairness
+ * deviation. A thread's service rate is its CPU time scaled by its weight 
+ * (thread_t::priority mapped to a CFS style load weight) over its turnaround;
+ * FAIRNESS is its rate less the mean rate of all exited threads, so 0 is a 
+ * perfectly weighted-fair share and negative means it was shortchanged.
+ */
+typedef struct __thread_stats_t {
+  unsigned int tid;
+  unsigned int waiting_time;
+  unsigned int turnaround_time;
+  unsigned int cpu_time;
+  double fairness;
+  unsigned int deadline;         // Real-time policies only, else 0
+  int lateness;                  // Completion less deadline, > 0 is a miss
+  unsigned int io_delay;         // Ticks queued for an I/O device, see io_stats()
+} thread_stats_t;
+
+/**
+ * Fill in STATS for the exited thread TID and return 0, or return -1 if 
+ * there is no such thread or it has not exited yet.
+ */
+int thread_stats(unsigned int tid, thread_stats_t *stats);
+
+/**
+ * Real-time policy results over exited threads.
+ */
+typedef struct __rt_stats_t {
+  unsigned int admitted;
+  unsigned int rejected;
+  unsigned int misses;           // Threads that completed after their deadline
+  int max_lateness;
+  double mean_lateness;
+} rt_stats_t;
+
+void rt_stats(rt_stats_t *stats);
+
+/**
+ * Multilevel feedback queue residency: LEVEL 0 is the top, shortest quantum 
+ * level. Ticks counts CPU time spent at the level, entries counts how many
+ * times a thread was queued there.
+ */
+typedef struct __level_stats_t {
+  unsigned int level;
+  unsigned int quantum;
+  unsigned int ticks;
+  unsigned int entries;
+} level_stats_t;
+
+/**
+ * Number of feedback queue levels.
+ */
+unsigned int mlfq_levels();
+
+/**
+ * Fill in STATS for LEVEL, 0 <= LEVEL < mlfq_levels().
+ */
+void mlfq_stats(unsigned int level, level_stats_t *stats);
+
+/**
+ * Dispatcher activity. A dispatch of the thread already on the CPU is
+ * elided rather than made. Of those made, every one but a new thread onto
+ * an idle CPU starts its thread the tick after (see simulator.h); that
+ * shifts the schedule but the CPU loses no tick to it. DEFERRED counts
+ * preemptions and rotations held off by set_switch_cost(), once per
+ * dispatch of the thread kept on the CPU however many ticks it keeps it.
+ */
+typedef struct __switch_stats_t {
+  unsigned int dispatches;       // sim_dispatch() of a thread
+  unsigned int elided;
+  unsigned int late_starts;      // Dispatches whose thread starts the tick after
+  unsigned int deferred;         // Dispatches whose thread kept the CPU past a switch
+} switch_stats_t;
+
+void switch_stats(switch_stats_t *stats);
+
+/**
+ * I/O, kept apart from CPU waiting. The simulator's waiting_time includes
+ * the ticks a thread spends queued for a device; here that queueing delay
+ * runs from the tick after sys_read()/sys_write() to io_starting(), and
+ * device time from io_starting() to io_complete(), both ticks included.
+ * Callbacks do not say which device an I/O is on, so BUSY is summed over
+ * every device and UTILIZATION, BUSY over sim_time(), is at most the number
+ * of devices. Delays count I/Os started, BUSY and IOS those completed.
+ */
+typedef struct __io_stats_t {
+  unsigned int ios;              // I/Os completed
+  unsigned int queued;           // Threads waiting for a device right now
+  unsigned long delay_sum;
+  unsigned int max_delay;
+  double mean_delay;             // Per I/O completed
+  unsigned long busy;
+  double utilization;
+} io_stats_t;
+
+void io_stats(io_stats_t *stats);
+
+/**
+ * CPU bursts, as measured for set_quantum_mode(), and the round robin
+ * quanta handed out; MEAN_QUANTUM is the fixed quantum if none were.
+ */
+typedef struct __quantum_stats_t {
+  unsigned int bursts;
+  double mean_burst;
+  double average;                // Moving average over all threads, now
+  double mean_quantum;
+} quantum_stats_t;
+
+void quantum_stats(quantum_stats_t *stats);
+
+#endif // __MONITOR_H
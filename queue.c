@@ -0,0 +1,625 @@
+/**
+ * See queue.h for details.
+ */
+#include <stdlib.h>
+#include "queue.h"
+
+/*= = = = = = = = = = = = = = = = = NODE POOL = = = = = = = = = = = = = = = = =*/
+
+//the calling OS thread's pool, see pool_use()
+__thread struct pool *node_pool = NULL;
+
+void pool_use(struct pool *pool)
+{
+  node_pool = pool;
+}
+
+struct node *node_alloc()
+{
+  if(node_pool->free == NULL)
+  {
+    struct slab *s = malloc(sizeof(struct slab));
+    s->next = node_pool->slabs;
+    node_pool->slabs = s;
+    for(int i = 0; i < SLAB_NODES; i++)
+    {
+      s->nodes[i].next = node_pool->free;
+      node_pool->free = &s->nodes[i];
+    }
+  }
+
+  struct node *n = node_pool->free;
+  node_pool->free = n->next;
+  return n;
+}
+
+void node_free(struct node *n)
+{
+  n->next = node_pool->free;
+  node_pool->free = n;
+}
+
+void pool_reset(struct pool *pool)
+{
+  while(pool->slabs != NULL)
+  {
+    struct slab *next = pool->slabs->next;
+    free(pool->slabs);
+    pool->slabs = next;
+  }
+  pool->free = NULL;
+}
+
+/*= = = = = = = = = = = = = = = = = FIFO = = = = = = = = = = = = = = = = =*/
+
+void fifo_push(struct fifo *q, thread_t *t, int quantum)
+{
+  struct node *new_node = node_alloc();
+  new_node->thread = t;
+  new_node->next = NULL;
+  new_node->quantum_ct = quantum;
+
+  if(q->first == NULL)
+  {
+    q->first = new_node;
+  }
+  else
+  {
+    q->last->next = new_node;
+  }
+  q->last = new_node;
+  q->size++;
+}
+
+thread_t *fifo_pop(struct fifo *q)
+{
+  struct node *first = q->first;
+  if(first == NULL)
+  {
+    return NULL;
+  }
+
+  thread_t *t = first->thread;
+  q->first = first->next;
+  if(q->first == NULL)
+  {
+    q->last = NULL;
+  }
+  q->size--;
+  node_free(first);
+  return t;
+}
+
+//move the head to the tail, reusing its node
+void fifo_rotate(struct fifo *q, int quantum)
+{
+  struct node *first = q->first;
+  if(first == NULL)
+  {
+    return;
+  }
+
+  first->quantum_ct = quantum;
+  if(first != q->last)
+  {
+    q->first = first->next;
+    first->next = NULL;
+    q->last->next = first;
+    q->last = first;
+  }
+}
+
+//move all of SRC to the tail of DST, leaving SRC empty
+void fifo_splice(struct fifo *dst, struct fifo *src)
+{
+  if(src->first == NULL)
+  {
+    return;
+  }
+
+  if(dst->first == NULL)
+  {
+    dst->first = src->first;
+  }
+  else
+  {
+    dst->last->next = src->first;
+  }
+  dst->last = src->last;
+  dst->size = dst->size + src->size;
+  *src = (struct fifo){0};
+}
+
+/*= = = = = = = = = = = = = = = = = BINARY HEAP = = = = = = = = = = = = = = = = =*/
+
+//A comes out before B: lower key first, then whichever was pushed first
+static int before(struct heap_entry *a, struct heap_entry *b)
+{
+  if(a->key != b->key)
+  {
+    return a->key < b->key;
+  }
+  return a->seq < b->seq;
+}
+
+static void swap(struct heap_entry *a, struct heap_entry *b)
+{
+  struct heap_entry tmp = *a;
+  *a = *b;
+  *b = tmp;
+}
+
+void heap_push(struct heap *h, thread_t *t, unsigned int key)
+{
+  if(h->size == h->cap)
+  {
+    h->cap = h->cap ? h->cap * 2 : 16;
+    h->entries = realloc(h->entries, sizeof(struct heap_entry) * h->cap);
+  }
+
+  unsigned int i = h->size++;
+  h->entries[i].key = key;
+  h->entries[i].seq = h->seq++;
+  h->entries[i].thread = t;
+
+  //sift up
+  while(i > 0 && before(&h->entries[i], &h->entries[(i - 1) / 2]))
+  {
+    swap(&h->entries[i], &h->entries[(i - 1) / 2]);
+    i = (i - 1) / 2;
+  }
+}
+
+thread_t *heap_pop(struct heap *h)
+{
+  if(h->size == 0)
+  {
+    return NULL;
+  }
+
+  thread_t *t = h->entries[0].thread;
+  h->entries[0] = h->entries[--h->size];
+
+  //sift down
+  unsigned int i = 0;
+  while(1)
+  {
+    unsigned int l = 2 * i + 1;
+    unsigned int r = l + 1;
+    unsigned int min = i;
+    if(l < h->size && before(&h->entries[l], &h->entries[min]))
+    {
+      min = l;
+    }
+    if(r < h->size && before(&h->entries[r], &h->entries[min]))
+    {
+      min = r;
+    }
+    if(min == i)
+    {
+      break;
+    }
+    swap(&h->entries[i], &h->entries[min]);
+    i = min;
+  }
+  return t;
+}
+
+thread_t *heap_peek(struct heap *h)
+{
+  return h->size ? h->entries[0].thread : NULL;
+}
+
+unsigned int heap_peek_key(struct heap *h)
+{
+  return h->entries[0].key;
+}
+
+void heap_free(struct heap *h)
+{
+  free(h->entries);
+  *h = (struct heap){0};
+}
+
+int heap_empty(struct heap *h)
+{
+  return h->size == 0;
+}
+
+/*= = = = = = = = = = = = = = = = = BUCKET QUEUE = = = = = = = = = = = = = = = = =*/
+
+//offset from the base of the first non-empty bucket; bucket i holds priority
+//i modulo BUCKETS, so the map is rotated to put the base's bucket at bit 0
+static unsigned int buckets_first(struct buckets *b)
+{
+  unsigned int shift = b->base % BUCKETS;
+  uint64_t map = shift ? b->map >> shift | b->map << (BUCKETS - shift) : b->map;
+  return __builtin_ctzll(map);
+}
+
+void buckets_push(struct buckets *b, thread_t *t, unsigned int priority)
+{
+  if(priority - b->base >= BUCKETS)
+  {
+    heap_push(&b->overflow, t, priority);
+    return;
+  }
+
+  fifo_push(&b->bucket[priority % BUCKETS], t, 0);
+  b->map |= (uint64_t)1 << (priority % BUCKETS);
+}
+
+thread_t *buckets_pop(struct buckets *b)
+{
+  if(b->map == 0)
+  {
+    return heap_pop(&b->overflow);
+  }
+
+  unsigned int i = (b->base + buckets_first(b)) % BUCKETS;
+  thread_t *t = fifo_pop(&b->bucket[i]);
+  if(b->bucket[i].first == NULL)
+  {
+    b->map &= ~((uint64_t)1 << i);
+  }
+  return t;
+}
+
+thread_t *buckets_peek(struct buckets *b)
+{
+  if(b->map == 0)
+  {
+    return heap_peek(&b->overflow);
+  }
+  return b->bucket[(b->base + buckets_first(b)) % BUCKETS].first->thread;
+}
+
+unsigned int buckets_peek_key(struct buckets *b)
+{
+  if(b->map == 0)
+  {
+    return heap_peek_key(&b->overflow);
+  }
+  return b->base + buckets_first(b);
+}
+
+int buckets_empty(struct buckets *b)
+{
+  return b->map == 0 && heap_empty(&b->overflow);
+}
+
+//nothing below FLOOR will be pushed again; the base moves up to it, or to the
+//first queued priority if that is lower
+void buckets_advance(struct buckets *b, unsigned int floor)
+{
+  if(!buckets_empty(b) && buckets_peek_key(b) < floor)
+  {
+    floor = buckets_peek_key(b);
+  }
+  if(floor <= b->base)
+  {
+    return;
+  }
+
+  //priorities now within reach of a bucket leave the heap, in the order they came
+  b->base = floor;
+  while(!heap_empty(&b->overflow) && heap_peek_key(&b->overflow) - b->base < BUCKETS)
+  {
+    unsigned int priority = heap_peek_key(&b->overflow);
+    thread_t *t = heap_pop(&b->overflow);
+    fifo_push(&b->bucket[priority % BUCKETS], t, 0);
+    b->map |= (uint64_t)1 << (priority % BUCKETS);
+  }
+}
+
+/*= = = = = = = = = = = = = = = = = RED-BLACK TREE = = = = = = = = = = = = = = = = =*/
+
+static int rb_before(struct rbnode *a, struct rbnode *b)
+{
+  if(a->key != b->key)
+  {
+    return a->key < b->key;
+  }
+  return a->seq < b->seq;
+}
+
+static int is_red(struct rbnode *n)
+{
+  return n != NULL && n->red;
+}
+
+static void rotate_left(struct rbtree *tree, struct rbnode *x)
+{
+  struct rbnode *y = x->right;
+  x->right = y->left;
+  if(y->left != NULL)
+  {
+    y->left->parent = x;
+  }
+  y->parent = x->parent;
+  if(x->parent == NULL)
+  {
+    tree->root = y;
+  }
+  else if(x == x->parent->left)
+  {
+    x->parent->left = y;
+  }
+  else
+  {
+    x->parent->right = y;
+  }
+  y->left = x;
+  x->parent = y;
+}
+
+static void rotate_right(struct rbtree *tree, struct rbnode *x)
+{
+  struct rbnode *y = x->left;
+  x->left = y->right;
+  if(y->right != NULL)
+  {
+    y->right->parent = x;
+  }
+  y->parent = x->parent;
+  if(x->parent == NULL)
+  {
+    tree->root = y;
+  }
+  else if(x == x->parent->right)
+  {
+    x->parent->right = y;
+  }
+  else
+  {
+    x->parent->left = y;
+  }
+  y->right = x;
+  x->parent = y;
+}
+
+void rb_insert(struct rbtree *tree, thread_t *t, unsigned long key)
+{
+  struct rbnode *z = tree->spare;
+  if(z != NULL)
+  {
+    tree->spare = z->left;
+  }
+  else
+  {
+    z = malloc(sizeof(struct rbnode));
+  }
+  z->key = key;
+  z->seq = tree->seq++;
+  z->thread = t;
+  z->left = NULL;
+  z->right = NULL;
+  z->red = 1;
+
+  //plain binary search tree insert
+  struct rbnode *parent = NULL;
+  struct rbnode *cur = tree->root;
+  while(cur != NULL)
+  {
+    parent = cur;
+    cur = rb_before(z, cur) ? cur->left : cur->right;
+  }
+  z->parent = parent;
+  if(parent == NULL)
+  {
+    tree->root = z;
+  }
+  else if(rb_before(z, parent))
+  {
+    parent->left = z;
+  }
+  else
+  {
+    parent->right = z;
+  }
+  if(tree->leftmost == NULL || rb_before(z, tree->leftmost))
+  {
+    tree->leftmost = z;
+  }
+  tree->size++;
+
+  //restore the red-black properties
+  while(is_red(z->parent))
+  {
+    struct rbnode *p = z->parent;
+    struct rbnode *g = p->parent;
+    if(p == g->left)
+    {
+      struct rbnode *u = g->right;
+      if(is_red(u))
+      {
+        p->red = 0;
+        u->red = 0;
+        g->red = 1;
+        z = g;
+      }
+      else
+      {
+        if(z == p->right)
+        {
+          z = p;
+          rotate_left(tree, z);
+          p = z->parent;
+        }
+        p->red = 0;
+        g->red = 1;
+        rotate_right(tree, g);
+      }
+    }
+    else
+    {
+      struct rbnode *u = g->left;
+      if(is_red(u))
+      {
+        p->red = 0;
+        u->red = 0;
+        g->red = 1;
+        z = g;
+      }
+      else
+      {
+        if(z == p->left)
+        {
+          z = p;
+          rotate_right(tree, z);
+          p = z->parent;
+        }
+        p->red = 0;
+        g->red = 1;
+        rotate_left(tree, g);
+      }
+    }
+  }
+  tree->root->red = 0;
+}
+
+//remove the leftmost node; it has no left child, so its right child takes its place
+thread_t *rb_pop(struct rbtree *tree)
+{
+  struct rbnode *z = tree->leftmost;
+  if(z == NULL)
+  {
+    return NULL;
+  }
+
+  //the in-order successor becomes the new minimum
+  struct rbnode *next = z->right;
+  if(next != NULL)
+  {
+    while(next->left != NULL)
+    {
+      next = next->left;
+    }
+  }
+  else
+  {
+    next = z->parent;
+  }
+  tree->leftmost = next;
+
+  struct rbnode *x = z->right;
+  struct rbnode *xp = z->parent;
+  if(xp == NULL)
+  {
+    tree->root = x;
+  }
+  else
+  {
+    xp->left = x;
+  }
+  if(x != NULL)
+  {
+    x->parent = xp;
+  }
+
+  if(!z->red)
+  {
+    while(x != tree->root && !is_red(x))
+    {
+      if(x == xp->left)
+      {
+        struct rbnode *w = xp->right;
+        if(is_red(w))
+        {
+          w->red = 0;
+          xp->red = 1;
+          rotate_left(tree, xp);
+          w = xp->right;
+        }
+        if(!is_red(w->left) && !is_red(w->right))
+        {
+          w->red = 1;
+          x = xp;
+          xp = x->parent;
+        }
+        else
+        {
+          if(!is_red(w->right))
+          {
+            w->left->red = 0;
+            w->red = 1;
+            rotate_right(tree, w);
+            w = xp->right;
+          }
+          w->red = xp->red;
+          xp->red = 0;
+          w->right->red = 0;
+          rotate_left(tree, xp);
+          x = tree->root;
+        }
+      }
+      else
+      {
+        struct rbnode *w = xp->left;
+        if(is_red(w))
+        {
+          w->red = 0;
+          xp->red = 1;
+          rotate_right(tree, xp);
+          w = xp->left;
+        }
+        if(!is_red(w->left) && !is_red(w->right))
+        {
+          w->red = 1;
+          x = xp;
+          xp = x->parent;
+        }
+        else
+        {
+          if(!is_red(w->left))
+          {
+            w->right->red = 0;
+            w->red = 1;
+            rotate_left(tree, w);
+            w = xp->left;
+          }
+          w->red = xp->red;
+          xp->red = 0;
+          w->left->red = 0;
+          rotate_right(tree, xp);
+          x = tree->root;
+        }
+      }
+    }
+    if(x != NULL)
+    {
+      x->red = 0;
+    }
+  }
+
+  thread_t *t = z->thread;
+  z->left = tree->spare;
+  tree->spare = z;
+  tree->size--;
+  return t;
+}
+
+unsigned long rb_min_key(struct rbtree *tree)
+{
+  return tree->leftmost->key;
+}
+
+void rb_free(struct rbtree *tree)
+{
+  while(!rb_empty(tree))
+  {
+    rb_pop(tree);
+  }
+  while(tree->spare != NULL)
+  {
+    struct rbnode *next = tree->spare->left;
+    free(tree->spare);
+    tree->spare = next;
+  }
+  *tree = (struct rbtree){0};
+}
+
+int rb_empty(struct rbtree *tree)
+{
+  return tree->root == NULL;
+}
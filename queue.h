@@ -0,0 +1,133 @@
+/**
+ * Ready queue implementations shared by the scheduling policies.
+ */
+#ifndef __QUEUE_H
+#define __QUEUE_H
+
+#include <stdint.h>
+#include "simulator.h"
+
+typedef struct node {
+    thread_t * thread;
+    struct node* next;
+    int quantum_ct;
+}node;
+
+/**
+ * All queue nodes come from a pool: a free list refilled a slab of 
+ * SLAB_NODES at a time, so steady-state scheduling does no heap allocation
+ * and memory is bounded by the most threads ever queued at once. Each OS 
+ * thread allocates from the pool last given to pool_use(), and pool_reset()
+ * releases every slab of POOL at the end of a simulation.
+ */
+#define SLAB_NODES 256
+
+typedef struct slab {
+    struct slab *next;
+    struct node nodes[SLAB_NODES];
+}slab;
+
+typedef struct pool {
+    struct node *free;
+    struct slab *slabs;
+}pool;
+
+void pool_use(struct pool *pool);
+struct node *node_alloc();
+void node_free(struct node *n);
+void pool_reset(struct pool *pool);
+
+/**
+ * FIFO with head and tail pointers; push, pop and rotate are all O(1). 
+ * Every push and rotate gives the thread a fresh QUANTUM.
+ */
+typedef struct fifo {
+    struct node *first;
+    struct node *last;
+    unsigned int size;
+}fifo;
+
+void fifo_push(struct fifo *q, thread_t *t, int quantum);
+thread_t *fifo_pop(struct fifo *q);
+void fifo_rotate(struct fifo *q, int quantum);
+void fifo_splice(struct fifo *dst, struct fifo *src);
+
+/**
+ * Array-backed binary min-heap ordered by KEY. Entries with equal keys come
+ * out in the order they were pushed, same as a sorted insert using <=.
+ * The array only grows; heap_free() releases it.
+ */
+typedef struct heap_entry {
+    unsigned int key;
+    unsigned long seq;
+    thread_t * thread;
+}heap_entry;
+
+typedef struct heap {
+    struct heap_entry *entries;
+    unsigned int size;
+    unsigned int cap;
+    unsigned long seq;
+}heap;
+
+void heap_push(struct heap *h, thread_t *t, unsigned int key);
+thread_t *heap_pop(struct heap *h);
+thread_t *heap_peek(struct heap *h);
+unsigned int heap_peek_key(struct heap *h);
+int heap_empty(struct heap *h);
+void heap_free(struct heap *h);
+
+/**
+ * Priority queue with one FIFO bucket per priority in the BUCKETS from BASE
+ * up and a bitmap of non-empty buckets, so picking the next thread is a
+ * single bit scan. Priorities past the last bucket rank after every bucket
+ * and go to a heap. No priority below BASE may be pushed; buckets_advance()
+ * moves BASE up for priorities that only ever grow, such as aged ones.
+ */
+#define BUCKETS 64
+
+typedef struct buckets {
+    uint64_t map;
+    unsigned int base;
+    struct fifo bucket[BUCKETS];
+    struct heap overflow;
+}buckets;
+
+void buckets_push(struct buckets *b, thread_t *t, unsigned int priority);
+thread_t *buckets_pop(struct buckets *b);
+thread_t *buckets_peek(struct buckets *b);
+unsigned int buckets_peek_key(struct buckets *b);
+int buckets_empty(struct buckets *b);
+void buckets_advance(struct buckets *b, unsigned int floor);
+
+/**
+ * Red-black tree ordered by KEY with the leftmost node cached, so the 
+ * minimum is O(1) to read and O(log n) to remove. Equal keys come out in the
+ * order they were inserted. Removed nodes are kept on a spare list for reuse
+ * until rb_free().
+ */
+typedef struct rbnode {
+    unsigned long key;
+    unsigned long seq;
+    thread_t * thread;
+    struct rbnode *left;
+    struct rbnode *right;
+    struct rbnode *parent;
+    int red;
+}rbnode;
+
+typedef struct rbtree {
+    struct rbnode *root;
+    struct rbnode *leftmost;
+    struct rbnode *spare;
+    unsigned int size;
+    unsigned long seq;
+}rbtree;
+
+void rb_insert(struct rbtree *tree, thread_t *t, unsigned long key);
+thread_t *rb_pop(struct rbtree *tree);
+unsigned long rb_min_key(struct rbtree *tree);
+int rb_empty(struct rbtree *tree);
+void rb_free(struct rbtree *tree);
+
+#endif // __QUEUE_H
@@ -2,15 +2,24 @@
  * See scheduler.h for function details. All are callbacks; i.e. the simulator 
  * calls you when something interesting happens.
  */
+#include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include "simulator.h"
 #include "scheduler.h"
-
-typedef struct node {
+#include "queue.h"
+#include "monitor.h"
+#include "smp.h"
+#include "algorithms.h"
+#include "context.h"
+#include "trace.h"
+#include "counters.h"
+
+//per-thread accounting, one record per tid in thread_table
+typedef struct record {
     thread_t * thread;
-    struct node* next;
-    int quantum_ct;
     int arrival;
     int completion;
     int turnaround;
@@ -18,29 +27,195 @@ typedef struct node {
     int io_wait;
     int io_start;
     int waittime;
+    int wait_start;
     int done;
-}node;
-
-//global variables to hold important info
-int count=0;
-unsigned int q_value;
-enum algorithm algo_number;
-
-//global thread variable to hold the running thread
-thread_t * running_thread = NULL;
-thread_t * io_thread = NULL;
-thread_t * td_off_cpu = NULL;
-
-//global head variable to hold ready queue
-struct node *head = NULL;
-struct node *thread_list = NULL;
-
-//borrowed list functions ::: CREDITS GIVEN IN COMMENTS BEFORE IMPLEMENTATION
-void sortedInsert(struct node** head_ref, thread_t *t);
-void append(struct node** head_ref, thread_t * t);
-void pop(struct node** head_ref);
-
-void turnaround(thread_t *td);
+    int remaining;
+    int run_start;
+    int level;
+    int level_epoch;
+    int cpu_time;
+    unsigned long vruntime;
+    double rate;
+    unsigned int deadline;
+    int admitted;
+    int io_asked;
+    int io_began;
+    unsigned int io_delay;
+    int burst_base;
+    unsigned int burst_avg;
+    unsigned int cpu;
+    int deferred;
+    unsigned int rank;
+}record;
+
+//one CPU; in multi-core mode each has its own ready queue and run slot
+typedef struct cpu {
+    thread_t * running;
+    struct heap ready;
+    int quantum_ct;
+    unsigned int busy;
+    unsigned int dispatches;
+    unsigned int steals;
+}cpu;
+
+//multilevel feedback queue: one round robin queue per level, quantum doubling
+//per level down, and a bitmap of non-empty levels with bit 0 the top level
+#define MLFQ_LEVELS 4
+#define MLFQ_BOOST 100
+
+//completely fair: ready threads in a red-black tree on weighted virtual
+//runtime, the running thread keeps the CPU for at least CFS_GRANULARITY ticks
+#define CFS_GRANULARITY 2
+#define NICE_0_LOAD 1024
+
+//real-time: admitted threads and their utilization, rejected ones queue
+//behind every admitted one
+#define RT_BACKGROUND 0x80000000u
+
+//everything one simulation needs, see context.h
+typedef struct context {
+    //important info
+    int count;
+    unsigned int q_value;
+    enum algorithm algo_number;
+    const struct policy *active;
+
+    //running totals over exited threads, kept up to date by sys_exit()
+    unsigned int finished;
+    unsigned long turnaround_sum;
+    unsigned long waiting_sum;
+    double rate_sum;
+
+    //every exited thread's waiting time, for tail latency
+    unsigned int *wait_samples;
+    unsigned int wait_sample_cap;
+    unsigned int max_waiting;
+
+    //the running thread
+    thread_t * running_thread;
+
+    //every ready queue allocates its nodes from here
+    struct pool pool;
+
+    //round robin ready queue
+    struct fifo rr_q;
+
+    //ready queue for the priority schedulers
+    struct buckets prio_q;
+
+    //adaptive round robin quantum: moving averages of CPU bursts, in 16ths
+    //of a tick, over every thread here and per thread in its record
+    enum quantum_mode quantum_mode;
+    enum quantum_mode quantum_request;
+    unsigned int burst_avg;
+    unsigned int bursts;
+    unsigned long burst_sum;
+    unsigned int quanta;
+    unsigned long quantum_sum;
+
+    //ticks per level of priority aging, 0 for none
+    unsigned int aging;
+    unsigned int aging_request;
+
+    //ready queue for first come first served
+    struct fifo fcfs_q;
+
+    //ready queue for shortest job, shortest remaining time and the real-time policies
+    struct heap ord_q;
+
+    //multilevel feedback queue
+    struct fifo mlfq_q[MLFQ_LEVELS];
+    unsigned int mlfq_map;
+    int mlfq_left;
+    int boost_epoch;
+    unsigned int level_ticks[MLFQ_LEVELS];
+    unsigned int level_entries[MLFQ_LEVELS];
+
+    //completely fair
+    struct rbtree cfs_q;
+    unsigned long min_vruntime;
+
+    //real-time
+    unsigned int deadline_factor;
+    unsigned int deadline_request;
+    unsigned int rt_running;
+    double rt_utilization;
+    unsigned int rt_admitted;
+    unsigned int rt_rejected;
+    unsigned int rt_misses;
+    int rt_max_lateness;
+    long rt_lateness_sum;
+
+    //CPU 0 is the simulator's, the rest are run by the stand-in dispatcher
+    struct cpu cpus[MAX_CPUS];
+    unsigned int cpu_total;
+    unsigned int cpu_request;
+
+    //policy whose key orders the per-CPU queues in multi-core mode
+    const struct policy *base;
+
+    //runs CPUs 1..N-1 in place of the stand-in dispatcher, see smp.h
+    void (*cpu_dispatch)(unsigned int cpu, thread_t *t);
+
+    //tid-indexed table of thread records, grown on demand so lookups are O(1)
+    struct record *thread_table;
+    unsigned int table_size;
+
+    //sim_time() of the last sim_ready(), waiting is charged per sim_ready() call
+    int last_ready;
+
+    //threads ready but not running, i.e. the length of the ready queue(s)
+    unsigned int waiting;
+
+    //the thread the simulator has on its CPU, as far as dispatches tell
+    thread_t * on_cpu;
+
+    //remaining CPU below which a thread is not switched out, 0 for none
+    unsigned int switch_cost;
+    unsigned int switch_cost_request;
+    unsigned int dispatches;
+    unsigned int elided;
+    unsigned int late_starts;
+    unsigned int deferred;
+
+    //I/O apart from CPU waiting: queueing delay for a device and device time
+    unsigned int io_count;
+    unsigned int io_queued;
+    unsigned long io_delay_sum;
+    unsigned int io_max_delay;
+    unsigned long io_busy;
+
+    //callback trace of the simulation in progress, and where to record the next
+    trace_writer_t *trace;
+    char *trace_path;
+    int trace_set;
+
+    //event counters of the simulation in progress, only kept with -DINSTRUMENT
+    counters_t counters;
+    char *counters_path;
+    int counters_set;
+}context;
+
+void drop_queues(struct context *c);
+struct record *track(thread_t *t);
+struct record *lookup(thread_t *t);
+void turnaround(struct record *rec);
+void finish(struct record *rec);
+
+int tick_clock();
+void account(struct record *rec);
+void set_ready(struct record *rec, int ready_q);
+void set_running(thread_t *t);
+int remaining_time(struct record *rec);
+void dispatch(thread_t *t);
+int worth_switching(thread_t *running);
+void leave_cpu(thread_t *t);
+void io_asked(thread_t *t);
+void io_began(thread_t *t);
+void io_done(thread_t *t);
+void end_burst(thread_t *t);
+void count_tick();
+void write_counters();
 
 // ROUND ROBIN SET OF FUNCTIONS
 void rr_sysready();
@@ -49,6 +224,7 @@ void rr_sys_rd_wr(thread_t *t);
 void rr_sysexit(thread_t *t);
 void rr_iocomplete(thread_t *t);
 void rr_iostarting(thread_t *t);
+int rr_quantum(thread_t *t);
 
 //NON-PREEMPTIVE PRIORITY SET OF FUNCTIONS
 void np_prio_sysready();
@@ -60,164 +236,353 @@ void np_prio_iostarting(thread_t *t);
 
 //PREEMPTIVE PRIORITY SET OF FUNCTIONS
 void prmtv_prio_sysready();
+unsigned int prio_rank(thread_t *t);
+void prio_push(thread_t *t);
 void prmtv_prio_sysexec(thread_t *t);
 void prmtv_prio_sys_rd_wr(thread_t *t);
 void prmtv_prio_sysexit(thread_t *t);
 void prmtv_prio_iocomplete(thread_t *t);
 void prmtv_prio_iostarting(thread_t *t);
 
+//FIRST COME FIRST SERVED SET OF FUNCTIONS, the rest are the ordered set's
+void fcfs_sysready();
+void fcfs_sysexec(thread_t *t);
+void fcfs_iocomplete(thread_t *t);
+
+//ORDERED SET OF FUNCTIONS, ready queue is a heap on the policy's key
+void np_ord_sysready();
+void p_ord_sysready();
+void ord_sysexec(thread_t *t);
+void ord_sys_rd_wr(thread_t *t);
+void ord_sysexit(thread_t *t);
+void ord_iocomplete(thread_t *t);
+void ord_iostarting(thread_t *t);
+
+//MULTILEVEL FEEDBACK QUEUE SET OF FUNCTIONS
+void mlfq_sysready();
+void mlfq_sysexec(thread_t *t);
+void mlfq_sys_rd_wr(thread_t *t);
+void mlfq_iocomplete(thread_t *t);
+void mlfq_push(struct record *rec, int level);
+int mlfq_level(struct record *rec);
+void mlfq_boost();
+
+//COMPLETELY FAIR SET OF FUNCTIONS
+void cfs_sysready();
+void cfs_sysexec(thread_t *t);
+void cfs_iocomplete(thread_t *t);
+void cfs_push(struct record *rec);
+unsigned int weight(thread_t *t);
+unsigned long live_vruntime(struct record *rec);
+
+//REAL-TIME SET OF FUNCTIONS, preemptive ordered set with admission control
+void rt_sysexec(thread_t *t);
+void rt_sysexit(thread_t *t);
+void rt_admit(struct record *rec);
+void rt_retire(struct record *rec);
+unsigned int edf_key(thread_t *t);
+unsigned int rm_key(thread_t *t);
+
+//MULTICORE SET OF FUNCTIONS, used for every policy when there is more than one CPU
+void smp_sysready();
+void smp_sysexec(thread_t *t);
+void smp_sys_rd_wr(thread_t *t);
+void smp_sysexit(thread_t *t);
+void smp_iocomplete(thread_t *t);
+void cpu_run(unsigned int i, thread_t *t);
+void cpu_tick(unsigned int i);
+void cpu_leave(struct record *rec);
+unsigned int least_loaded();
+thread_t *steal(unsigned int i);
+
+//keys for the ordered set, lower runs first
+unsigned int fcfs_key(thread_t *t);
+unsigned int sjf_key(thread_t *t);
+unsigned int srtf_key(thread_t *t);
+unsigned int prio_key(thread_t *t);
+
+//one set of callbacks per scheduling policy, selected once in scheduler()
+typedef struct policy {
+    void (*sysready)();
+    void (*sysexec)(thread_t *t);
+    void (*sysread)(thread_t *t);
+    void (*syswrite)(thread_t *t);
+    void (*sysexit)(thread_t *t);
+    void (*iocomplete)(thread_t *t);
+    void (*iostarting)(thread_t *t);
+    unsigned int (*key)(thread_t *t);
+}policy;
+
+//indexed by enum algorithm, register new policies here
+const struct policy policies[] = {
+  [FIRST_COME_FIRST_SERVED] = { fcfs_sysready, fcfs_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                                ord_sysexit, fcfs_iocomplete, ord_iostarting, fcfs_key },
+  [ROUND_ROBIN] = { rr_sysready, rr_sysexec, rr_sys_rd_wr, rr_sys_rd_wr,
+                    rr_sysexit, rr_iocomplete, rr_iostarting, fcfs_key },
+  [NON_PREEMPTIVE_PRIORITY] = { np_prio_sysready, np_prio_sysexec, np_prio_sys_rd_wr, np_prio_sys_rd_wr,
+                                np_prio_sysexit, np_prio_iocomplete, np_prio_iostarting, prio_key },
+  [PREEMPTIVE_PRIORITY] = { prmtv_prio_sysready, prmtv_prio_sysexec, prmtv_prio_sys_rd_wr, prmtv_prio_sys_rd_wr,
+                            prmtv_prio_sysexit, prmtv_prio_iocomplete, prmtv_prio_iostarting, prio_key },
+  [NON_PREEMPTIVE_SHORTEST_JOB_FIRST] = { np_ord_sysready, ord_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                                          ord_sysexit, ord_iocomplete, ord_iostarting, sjf_key },
+  [PREEMPTIVE_SHORTEST_JOB_FIRST] = { p_ord_sysready, ord_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                                      ord_sysexit, ord_iocomplete, ord_iostarting, sjf_key },
+  [NON_PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST] = { np_ord_sysready, ord_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                                                     ord_sysexit, ord_iocomplete, ord_iostarting, srtf_key },
+  [PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST] = { p_ord_sysready, ord_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                                                 ord_sysexit, ord_iocomplete, ord_iostarting, srtf_key },
+  [MULTILEVEL_FEEDBACK_QUEUE] = { mlfq_sysready, mlfq_sysexec, mlfq_sys_rd_wr, mlfq_sys_rd_wr,
+                                  ord_sysexit, mlfq_iocomplete, ord_iostarting, fcfs_key },
+  [COMPLETELY_FAIR] = { cfs_sysready, cfs_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                        ord_sysexit, cfs_iocomplete, ord_iostarting, fcfs_key },
+  [EARLIEST_DEADLINE_FIRST] = { p_ord_sysready, rt_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                                rt_sysexit, ord_iocomplete, ord_iostarting, edf_key },
+  [RATE_MONOTONIC] = { p_ord_sysready, rt_sysexec, ord_sys_rd_wr, ord_sys_rd_wr,
+                       rt_sysexit, ord_iocomplete, ord_iostarting, rm_key },
+};
+
+const char *algorithm_names[] = {
+  [FIRST_COME_FIRST_SERVED] = "fcfs",
+  [ROUND_ROBIN] = "rr",
+  [NON_PREEMPTIVE_PRIORITY] = "np-priority",
+  [PREEMPTIVE_PRIORITY] = "p-priority",
+  [NON_PREEMPTIVE_SHORTEST_JOB_FIRST] = "np-sjf",
+  [PREEMPTIVE_SHORTEST_JOB_FIRST] = "p-sjf",
+  [NON_PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST] = "np-srtf",
+  [PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST] = "p-srtf",
+  [MULTILEVEL_FEEDBACK_QUEUE] = "mlfq",
+  [COMPLETELY_FAIR] = "cfs",
+  [EARLIEST_DEADLINE_FIRST] = "edf",
+  [RATE_MONOTONIC] = "rm",
+};
+
+const struct policy smp_policy = { smp_sysready, smp_sysexec, smp_sys_rd_wr, smp_sys_rd_wr,
+                                   smp_sysexit, smp_iocomplete, ord_iostarting };
+
+//threads that never call context_use() share this one
+struct context fallback = { .active = &policies[FIRST_COME_FIRST_SERVED], .last_ready = -1 };
+
+//the calling OS thread's current context
+__thread struct context *ctx = &fallback;
+
+//building with -DSPECIALIZE=<algorithm> fixes the policy at compile time, so
+//every ACTIVE-> call is a direct call the compiler can inline; scheduler()
+//then ignores its ALGORITHM and there is no multi-core mode
+#ifdef SPECIALIZE
+#define ACTIVE (&policies[SPECIALIZE])
+#else
+#define ACTIVE (ctx->active)
+#endif
+
+//append a KIND record for T to the simulation's trace, if it is being recorded
+#define TRACE(kind, t) do { if(ctx->trace != NULL) trace_write(ctx->trace, kind, sim_time(), t, ctx->waiting); } while(0)
+
+//event counters, see counters.h; without -DINSTRUMENT these compile to nothing
+#ifdef INSTRUMENT
+#define COUNT(field) (ctx->counters.field++)
+#define COUNT_ADD(field, n) (ctx->counters.field += (n))
+#define SAMPLE(hist, v) (ctx->counters.hist[counter_bucket(v)]++)
+#else
+#define COUNT(field) ((void)0)
+#define COUNT_ADD(field, n) ((void)0)
+#define SAMPLE(hist, v) ((void)0)
+#endif
+
 
 void scheduler(enum algorithm algorithm, unsigned int quantum) 
 {
-  q_value = quantum;
-  algo_number = algorithm;
-}
-
-void sim_tick() { }
+  //a new simulation in the current context
+  context_reset(ctx);
+  pool_use(&ctx->pool);
 
-void sim_ready() 
-{
-  if(algo_number == ROUND_ROBIN)
+  //the simulator can only ask for the originals, anything running in a context of its own means what it asks for
+  if(ctx == &fallback && getenv("SCHED_ALGORITHM") != NULL && algorithm_by_name(getenv("SCHED_ALGORITHM")) >= 0)
   {
-    rr_sysready();
+    algorithm = algorithm_by_name(getenv("SCHED_ALGORITHM"));
   }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
+  if((int)algorithm < 0 || (int)algorithm >= ALGORITHM_COUNT)
   {
-    np_prio_sysready();
+    algorithm = FIRST_COME_FIRST_SERVED;
   }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
+#ifdef SPECIALIZE
+  if(algorithm != SPECIALIZE)
   {
-    prmtv_prio_sysready();
+    static int warned = 0;
+    if(!__atomic_exchange_n(&warned, 1, __ATOMIC_RELAXED))
+    {
+      fprintf(stderr, "scheduler: built for %s only, running it instead of %s\n", algorithm_name(SPECIALIZE),
+              algorithm_name(algorithm));
+    }
+    algorithm = SPECIALIZE;
   }
-}
+#endif
 
-void sys_exec(thread_t *t) 
-{
-  count++;
-  if(algo_number == ROUND_ROBIN)
+  ctx->q_value = quantum;
+  ctx->algo_number = algorithm;
+  ctx->active = &policies[algorithm];
+  ctx->base = ctx->active;
+
+  if(ctx->cpu_request == 0 && getenv("SCHED_CPUS") != NULL)
   {
-    rr_sysexec(t);
+    set_cpus(atoi(getenv("SCHED_CPUS")));
   }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
+  ctx->cpu_total = ctx->cpu_request ? ctx->cpu_request : 1;
+
+  if(ctx->aging_request == 0 && getenv("SCHED_AGING") != NULL)
   {
-    np_prio_sysexec(t);
+    set_aging(atoi(getenv("SCHED_AGING")));
   }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
+  ctx->aging = ctx->aging_request;
+
+  if(ctx->quantum_request == QUANTUM_FIXED && getenv("SCHED_QUANTUM") != NULL)
   {
-    prmtv_prio_sysexec(t);
+    const char *mode = getenv("SCHED_QUANTUM");
+    set_quantum_mode(strcmp(mode, "global") == 0 ? QUANTUM_GLOBAL
+                     : strcmp(mode, "thread") == 0 ? QUANTUM_PER_THREAD : QUANTUM_FIXED);
   }
-}
+  ctx->quantum_mode = ctx->quantum_request;
+  ctx->burst_avg = quantum * 16;
 
-void sys_read(thread_t *t) 
-{ 
-  if(algo_number == ROUND_ROBIN)
+  if(ctx->switch_cost_request == 0 && getenv("SCHED_SWITCH_COST") != NULL)
   {
-    rr_sys_rd_wr(t);
+    set_switch_cost(atoi(getenv("SCHED_SWITCH_COST")));
   }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
+  ctx->switch_cost = ctx->switch_cost_request;
+
+  if(ctx->deadline_request == 0 && getenv("SCHED_DEADLINE_FACTOR") != NULL)
   {
-    np_prio_sys_rd_wr(t);
+    set_deadline_factor(atoi(getenv("SCHED_DEADLINE_FACTOR")));
   }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
+  ctx->deadline_factor = ctx->deadline_request ? ctx->deadline_request : 4;
+
+  if(!ctx->trace_set && getenv("SCHED_TRACE") != NULL)
   {
-    prmtv_prio_sys_rd_wr(t);
+    set_trace(getenv("SCHED_TRACE"));
   }
-}
-
-void sys_write(thread_t *t) 
-{
-  if(algo_number == ROUND_ROBIN)
+  if(ctx->trace_path != NULL)
+  {
+    ctx->trace = trace_create(ctx->trace_path, algorithm, quantum);
+  }
+  if(!ctx->counters_set && getenv("SCHED_COUNTERS") != NULL)
   {
-    rr_sys_rd_wr(t);
+    set_counters(getenv("SCHED_COUNTERS"));
   }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
+#ifdef SPECIALIZE
+  ctx->cpu_total = 1;
+#else
+  //the feedback levels and the virtual runtime tree have no per-CPU form
+  if(ctx->cpu_total > 1 && (algorithm == (enum algorithm)MULTILEVEL_FEEDBACK_QUEUE
+                            || algorithm == (enum algorithm)COMPLETELY_FAIR))
   {
-    np_prio_sys_rd_wr(t);
+    static int warned = 0;
+    if(!__atomic_exchange_n(&warned, 1, __ATOMIC_RELAXED))
+    {
+      fprintf(stderr, "scheduler: %s has no multi-core mode, running on one CPU\n", algorithm_name(algorithm));
+    }
+    ctx->cpu_total = 1;
   }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
+  if(ctx->cpu_total > 1)
   {
-    prmtv_prio_sys_rd_wr(t);
+    ctx->active = &smp_policy;
   }
+#endif
+}
+
+void sim_tick() { }
+
+void sim_ready() 
+{
+  TRACE(TRACE_READY, NULL);
+  ACTIVE->sysready();
+  ctx->last_ready = sim_time();
+#ifdef INSTRUMENT
+  count_tick();
+#endif
+}
+
+void sys_exec(thread_t *t) 
+{
+  TRACE(TRACE_EXEC, t);
+  ctx->count++;
+  ACTIVE->sysexec(t);
+}
+
+void sys_read(thread_t *t) 
+{ 
+  TRACE(TRACE_READ, t);
+  end_burst(t);
+  leave_cpu(t);
+  io_asked(t);
+  ACTIVE->sysread(t);
+}
+
+void sys_write(thread_t *t) 
+{
+  TRACE(TRACE_WRITE, t);
+  end_burst(t);
+  leave_cpu(t);
+  io_asked(t);
+  ACTIVE->syswrite(t);
 }
 
 void sys_exit(thread_t *t) 
 { 
-  if(algo_number == ROUND_ROBIN)
-  {
-    rr_sysexit(t);
-  }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
-  {
-    np_prio_sysexit(t);
-  }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
-  {
-    prmtv_prio_sysexit(t);
-  }
+  TRACE(TRACE_EXIT, t);
+  end_burst(t);
+  leave_cpu(t);
+  ACTIVE->sysexit(t);
+  finish(lookup(t));
 }
 
 void io_complete(thread_t *t) 
 { 
-  if(algo_number == ROUND_ROBIN)
-  {
-    rr_iocomplete(t);
-  }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
-  {
-    np_prio_iocomplete(t);
-  }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
-  {
-    prmtv_prio_iocomplete(t);
-  }
+  TRACE(TRACE_IO_COMPLETE, t);
+  io_done(t);
+  ACTIVE->iocomplete(t);
 }
 
 void io_starting(thread_t *t)
 {
-  if(algo_number == ROUND_ROBIN)
-  {
-    rr_iostarting(t);
-  }
-  else if(algo_number == NON_PREEMPTIVE_PRIORITY)
-  {
-    np_prio_iostarting(t);
-  }
-  else if(algo_number == PREEMPTIVE_PRIORITY)
-  {
-    prmtv_prio_iostarting(t);
-  }
+  TRACE(TRACE_IO_STARTING, t);
+  io_began(t);
+  ACTIVE->iostarting(t);
 }
 
 stats_t *stats()
 { 
-  int thread_count = count;
+  int thread_count = ctx->count;
   stats_t *stats = malloc(sizeof(stats_t));
   stats->tstats = malloc(sizeof(stats_t) * thread_count);
 
-
-  struct node *temp = thread_list;
-
-  while(temp != NULL)
+  //the table is in tid order, so one pass fills tstats without assuming
+  //tids run 1..count
+  int x = 0;
+  for(unsigned int i = 0; i < ctx->table_size && x < thread_count; i++)
   {
-    turnaround(temp->thread);
-    temp = temp->next;
+    struct record *rec = &ctx->thread_table[i];
+    if(rec->thread == NULL)
+    {
+      continue;
+    }
+    stats->tstats[x].tid = rec->thread->tid;
+    stats->tstats[x].turnaround_time = rec->turnaround;
+    stats->tstats[x].waiting_time = rec->waittime; 
+    x++;
   }
+  stats->thread_count = ctx->count;
+  stats->turnaround_time = ctx->count ? ctx->turnaround_sum/ctx->count : 0;
+  stats->waiting_time = ctx->count ? ctx->waiting_sum/ctx->count : 0;
 
-  temp = thread_list;
-  int x = 0;
-  int y = 0;
-  while(temp != NULL)
+  //simulation is over, drop the queues and hand back every node at once
+  drop_queues(ctx);
+  if(ctx->trace != NULL)
   {
-    stats->tstats[temp->thread->tid - 1].tid = temp->thread->tid;
-    stats->tstats[temp->thread->tid - 1].turnaround_time = temp->turnaround;
-    stats->tstats[temp->thread->tid - 1].waiting_time = temp->waittime; 
-    x = x + temp->turnaround;
-    y = y + temp->waittime;
-    temp=temp->next;
+    trace_close(ctx->trace);
+    ctx->trace = NULL;
   }
-  stats->thread_count = count;
-  stats->turnaround_time = x/count;
-  stats->waiting_time = y/count;
+#ifdef INSTRUMENT
+  write_counters();
+#endif
 
   return stats;
 }
@@ -228,165 +593,160 @@ stats_t *stats()
 
 void rr_sysready()
 {
-  if(running_thread != NULL && head != NULL)
+  if(ctx->running_thread != NULL && ctx->rr_q.first != NULL)
   { 
-    if(head->quantum_ct == 0)
+    //past its quantum if worth_switching() held the rotation off before
+    if(ctx->rr_q.first->quantum_ct <= 0 && (ctx->rr_q.size == 1 || worth_switching(ctx->running_thread)))
     {
-      struct node *temp_x;
-      temp_x = thread_list;
-      while(temp_x->thread->tid != head->thread->tid)
-      {
-        temp_x = temp_x->next;
-      }
-      temp_x->ready_q = 1;
-
-      thread_t *temp = head->thread;
-      pop(&head);
-      append(&head, temp);
-      sim_dispatch(head->thread);
-      head->ready_q = 0;
-      running_thread = head->thread;
-    }
-    head->quantum_ct--;
-  }
+      set_ready(lookup(ctx->rr_q.first->thread), 1);
+      COUNT(rotations);
 
-  struct node *temp_n;
-  temp_n = thread_list;
-  while(temp_n != NULL)
-  {
-    if(temp_n->thread != running_thread && temp_n->done == 0)
-    {
-      if(temp_n->ready_q == 1)
-      {
-        temp_n->waittime++;
-      }
+      fifo_rotate(&ctx->rr_q, rr_quantum(ctx->rr_q.first->thread));
+      dispatch(ctx->rr_q.first->thread);
+      set_running(ctx->rr_q.first->thread);
     }
-    temp_n = temp_n->next;
+    ctx->rr_q.first->quantum_ct--;
   }
 }
 
 void rr_sysexec(thread_t *t)
 {
+  struct record *temp = track(t);
+  fifo_push(&ctx->rr_q, t, rr_quantum(t));
 
-  append(&head, t);
-  append(&thread_list, t);
-
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
   temp->arrival = sim_time();
   temp->waittime = 0;
-  temp->ready_q = 1;
+  set_ready(temp, 1);
   temp->done = 0;
   
-  if(head != NULL)
+  if(ctx->rr_q.first != NULL)
   {
-    sim_dispatch(head->thread);
-    running_thread = head->thread;
+    dispatch(ctx->rr_q.first->thread);
+    set_running(ctx->rr_q.first->thread);
   }
 
-  if(running_thread == temp->thread)
+  if(ctx->running_thread == temp->thread)
   {
-    temp->ready_q = 0;
+    set_ready(temp, 0);
   }
 }
 
 void rr_sys_rd_wr(thread_t *t)
 {
   
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 0;
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
   temp->io_wait = sim_time();
 
-  pop(&head);
-  if(head != NULL)
+  fifo_pop(&ctx->rr_q);
+  if(ctx->rr_q.first != NULL)
+  {
+    dispatch(ctx->rr_q.first->thread);
+    set_running(ctx->rr_q.first->thread);
+  }
+  else
   {
-    sim_dispatch(head->thread);
-    running_thread = head->thread;
+    set_running(NULL);
   }
 }
 
 void rr_sysexit(thread_t *t)
 {
   
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
+  struct record *temp = lookup(t);
   temp->completion = sim_time();
-  temp->ready_q = 0;
+  set_ready(temp, 0);
   temp->done = 1;
 
-  pop(&head);
-  if(head != NULL)
+  fifo_pop(&ctx->rr_q);
+  if(ctx->rr_q.first != NULL)
+  {
+    dispatch(ctx->rr_q.first->thread);
+    set_running(ctx->rr_q.first->thread);
+  }
+  else
   {
-    sim_dispatch(head->thread);
-    running_thread = head->thread;
+    set_running(NULL);
   }
-  if(running_thread == temp->thread)
+  if(ctx->running_thread == temp->thread)
   {
-    temp->ready_q = 0;
+    set_ready(temp, 0);
   }
 }
 
 void rr_iocomplete(thread_t *t)
 {
   
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 1;
+  struct record *temp = lookup(t);
+  set_ready(temp, 1);
 
-  append(&head, t);
-  if(head != NULL)
+  fifo_push(&ctx->rr_q, t, rr_quantum(t));
+  if(ctx->rr_q.first != NULL)
   {
-    sim_dispatch(head->thread);
-    running_thread = head->thread;
+    dispatch(ctx->rr_q.first->thread);
+    set_running(ctx->rr_q.first->thread);
   }
-  if(running_thread == temp->thread)
+  if(ctx->running_thread == temp->thread)
   {
-    temp->ready_q = 0;
+    set_ready(temp, 0);
   }
-  io_thread = NULL;
 }
 
 void rr_iostarting(thread_t *t)
 {
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 0;
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
   temp->io_start = sim_time();
 
   temp->waittime = temp->waittime + (temp->io_start - temp->io_wait - 1);
   temp->io_wait = 0;
   temp->io_start = 0;
 
-  if(head != NULL)
+  if(ctx->rr_q.first != NULL)
+  {
+    dispatch(ctx->rr_q.first->thread);
+    set_running(ctx->rr_q.first->thread);
+  }
+  if(ctx->running_thread == temp->thread)
+  {
+    set_ready(temp, 0);
+  }
+}
+
+//the quantum T gets for its next turn at the head of the queue: the fixed
+//one, or the moving average of CPU bursts rounded up and kept within 1 and
+//8 times the fixed one
+int rr_quantum(thread_t *t)
+{
+  if(ctx->quantum_mode == QUANTUM_FIXED)
   {
-    sim_dispatch(head->thread);
-    running_thread = head->thread;
+    return ctx->q_value;
   }
-  if(running_thread == temp->thread)
+
+  unsigned int avg = ctx->burst_avg;
+  if(ctx->quantum_mode == QUANTUM_PER_THREAD)
   {
-    temp->ready_q = 0;
+    avg = lookup(t)->burst_avg;
   }
+  unsigned int quantum = (avg + 15) / 16;
+  unsigned int cap = 8 * ctx->q_value;
+  quantum = quantum < 1 ? 1 : quantum > cap ? cap : quantum;
+  ctx->quanta++;
+  ctx->quantum_sum = ctx->quantum_sum + quantum;
+  return quantum;
+}
+
+void set_quantum_mode(enum quantum_mode mode)
+{
+  ctx->quantum_request = mode;
+}
+
+void quantum_stats(quantum_stats_t *stats)
+{
+  stats->bursts = ctx->bursts;
+  stats->mean_burst = ctx->bursts ? (double)ctx->burst_sum / ctx->bursts : 0;
+  stats->average = ctx->burst_avg / 16.0;
+  stats->mean_quantum = ctx->quanta ? (double)ctx->quantum_sum / ctx->quanta : ctx->q_value;
 }
 /*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
 
@@ -395,297 +755,1418 @@ void rr_iostarting(thread_t *t)
 void np_prio_sysready()
 {
 
-  struct node *temp;
-
-  if(running_thread == NULL && head != NULL)
+  if(ctx->running_thread == NULL && !buckets_empty(&ctx->prio_q))
   {
-    running_thread = head->thread;
-    sim_dispatch(running_thread);
-    pop(&head);
+    set_running(buckets_peek(&ctx->prio_q));
+    dispatch(ctx->running_thread);
+    buckets_pop(&ctx->prio_q);
     
-    temp = thread_list;
-    while(temp->thread != running_thread)
-    {
-      temp = temp->next;
-    }
-    temp->ready_q = 0;
-  }
-
-  temp = thread_list;
-  while(temp != NULL)
-  {
-    if(temp->ready_q == 1 && temp->thread != running_thread && temp->done != 1)
-    {
-      temp->waittime++;
-    }
-    temp = temp->next;
+    set_ready(lookup(ctx->running_thread), 0);
   }
   
 }
 
 void np_prio_sysexec(thread_t *t)
 {  
-  append(&thread_list, t);
-  sortedInsert(&head, t);
-
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
+  struct record *temp = track(t);
+  prio_push(t);
   temp->arrival = sim_time();
-  temp->ready_q = 1;
+  set_ready(temp, 1);
 }
 
 void np_prio_sys_rd_wr(thread_t *t)
 {
-  running_thread = NULL;
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 0;
+  set_running(NULL);
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
   temp->io_wait = sim_time();
 }
 
 void np_prio_sysexit(thread_t *t)
 {
-  running_thread = NULL;
+  set_running(NULL);
 
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
+  struct record *temp = lookup(t);
   temp->completion = sim_time();
-  temp->ready_q = 0;
+  set_ready(temp, 0);
 
 }
 
 void np_prio_iocomplete(thread_t *t)
 {
-  sortedInsert(&head, t);
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 1;
+  prio_push(t);
+  set_ready(lookup(t), 1);
 }
 
 void np_prio_iostarting(thread_t *t)
 {
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 0;
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
   temp->io_start = sim_time();
 
   temp->waittime = temp->waittime + (temp->io_start - temp->io_wait - 1);
 }
 
+
 /*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
 
 /*= = = = = = = = = = = = = = = = = PREEMPTIVE_PRIO FUNCTIONS = = = = = = = = = = = = = = = = =*/
 void prmtv_prio_sysready()
 {
 
-  if(head != NULL)
+  if(!buckets_empty(&ctx->prio_q))
   {
-    if(running_thread == NULL)
-    {
-      running_thread = head->thread;
-      pop(&head);
-      sim_dispatch(running_thread);
-    }
-    else if(running_thread->priority > head->thread->priority)
+    if(ctx->running_thread == NULL)
     {
-      sortedInsert(&head, running_thread);
-      running_thread = head->thread;
-      pop(&head);
-      sim_dispatch(running_thread);
+      set_running(buckets_peek(&ctx->prio_q));
+      buckets_pop(&ctx->prio_q);
+      dispatch(ctx->running_thread);
     }
-  }
-
-  struct node *temp;
-  temp = thread_list;
-  while(temp != NULL)
-  {
-    if(temp->ready_q == 1 && temp->thread != running_thread && temp->done != 1)
+    //the running thread keeps the rank it waited its way up to
+    else if(lookup(ctx->running_thread)->rank > buckets_peek_key(&ctx->prio_q) && worth_switching(ctx->running_thread))
     {
-      temp->waittime++;
+      COUNT(preemptions);
+      prio_push(ctx->running_thread);
+      set_running(buckets_peek(&ctx->prio_q));
+      buckets_pop(&ctx->prio_q);
+      dispatch(ctx->running_thread);
     }
-    temp = temp->next;
   }
 }
 
 void prmtv_prio_sysexec(thread_t *t)
 {
-  append(&thread_list, t);
-  sortedInsert(&head, t);
-
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
+  struct record *temp = track(t);
+  prio_push(t);
   temp->arrival = sim_time();
-  temp->ready_q = 1;
+  set_ready(temp, 1);
 }
 
 void prmtv_prio_sys_rd_wr(thread_t *t)
 {
-  running_thread = NULL;
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
-  temp->ready_q = 0;
+  set_running(NULL);
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
   temp->io_wait = sim_time();
 }
 
 void prmtv_prio_sysexit(thread_t *t)
 {
-  running_thread = NULL;
+  set_running(NULL);
 
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
-  {
-    temp = temp->next;
-  }
+  struct record *temp = lookup(t);
   temp->completion = sim_time();
-  temp->ready_q = 0;
+  set_ready(temp, 0);
 }
 
 void prmtv_prio_iocomplete(thread_t *t)
 {
-  sortedInsert(&head, t);
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
+  prio_push(t);
+  set_ready(lookup(t), 1);
+}
+
+void prmtv_prio_iostarting(thread_t *t)
+{
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
+  temp->io_start = sim_time();
+
+  temp->waittime = temp->waittime + (temp->io_start - temp->io_wait - 1);
+}
+
+//queue key for T entering now; with aging, each INTERVAL ticks lowers the key
+//new entries get by one, so threads already queued rank a level better
+//relative to them without ever being re-keyed
+unsigned int prio_rank(thread_t *t)
+{
+  if(ctx->aging == 0)
   {
-    temp = temp->next;
+    return t->priority;
   }
-  temp->ready_q = 1;
+  return t->priority + tick_clock() / ctx->aging;
 }
 
-void prmtv_prio_iostarting(thread_t *t)
+//ranks only grow with the clock, so the buckets can follow the current one
+//rather than spill every rank past the 64th into their heap
+void prio_push(thread_t *t)
 {
-  struct node *temp;
-  temp = thread_list;
-  while(temp->thread->tid != t->tid)
+  if(ctx->aging)
   {
-    temp = temp->next;
+    buckets_advance(&ctx->prio_q, tick_clock() / ctx->aging);
   }
-  temp->ready_q = 0;
-  temp->io_start = sim_time();
+  struct record *rec = lookup(t);
+  rec->rank = prio_rank(t);
+  buckets_push(&ctx->prio_q, t, rec->rank);
+}
 
-  temp->waittime = temp->waittime + (temp->io_start - temp->io_wait - 1);
+void set_aging(unsigned int interval)
+{
+  ctx->aging_request = interval;
 }
 
 /*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
 
+/*= = = = = = = = = = = = = = = = = FCFS FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void fcfs_sysready()
+{
+  if(ctx->running_thread == NULL && ctx->fcfs_q.first != NULL)
+  {
+    set_running(fifo_pop(&ctx->fcfs_q));
+    dispatch(ctx->running_thread);
+    set_ready(lookup(ctx->running_thread), 0);
+  }
+}
+
+void fcfs_sysexec(thread_t *t)
+{
+  struct record *temp = track(t);
+  temp->arrival = sim_time();
+
+  fifo_push(&ctx->fcfs_q, t, 0);
+  set_ready(temp, 1);
+}
 
-void turnaround(thread_t *td)
+void fcfs_iocomplete(thread_t *t)
 {
-  struct node *temp;
-  temp = thread_list;
+  fifo_push(&ctx->fcfs_q, t, 0);
+  set_ready(lookup(t), 1);
+}
 
-  while(temp->thread->tid != td->tid)
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+/*= = = = = = = = = = = = = = = = = ORDERED FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void np_ord_sysready()
+{
+  if(ctx->running_thread == NULL && !heap_empty(&ctx->ord_q))
   {
-    temp = temp->next;
+    set_running(heap_pop(&ctx->ord_q));
+    dispatch(ctx->running_thread);
+    set_ready(lookup(ctx->running_thread), 0);
   }
+}
 
-  temp->turnaround = temp->completion - temp->arrival + 1;
+void p_ord_sysready()
+{
+  if(!heap_empty(&ctx->ord_q))
+  {
+    if(ctx->running_thread == NULL)
+    {
+      set_running(heap_pop(&ctx->ord_q));
+      dispatch(ctx->running_thread);
+      set_ready(lookup(ctx->running_thread), 0);
+    }
+    else if(ACTIVE->key(ctx->running_thread) > heap_peek_key(&ctx->ord_q) && worth_switching(ctx->running_thread))
+    {
+      COUNT(preemptions);
+      struct record *prev = lookup(ctx->running_thread);
+      heap_push(&ctx->ord_q, ctx->running_thread, ACTIVE->key(ctx->running_thread));
+      set_running(heap_pop(&ctx->ord_q));
+      dispatch(ctx->running_thread);
+      set_ready(prev, 1);
+      set_ready(lookup(ctx->running_thread), 0);
+    }
+  }
 }
 
-//borrowed from https://www.geeksforgeeks.org/given-a-linked-list-which-is-sorted-how-will-you-insert-in-sorted-way/
-//then altered for use in this assignment
-void sortedInsert(struct node** head_ref, thread_t *t) 
-{ 
-    struct node* new_node = (struct node*)malloc(sizeof(struct node));
-    new_node->next = NULL;
-    new_node->thread = t;
+void ord_sysexec(thread_t *t)
+{
+  struct record *temp = track(t);
+  temp->arrival = sim_time();
+  temp->remaining = t->length;
 
-    struct node *temp;
+  heap_push(&ctx->ord_q, t, ACTIVE->key(t));
+  set_ready(temp, 1);
+}
 
-    if (*head_ref == NULL || (*head_ref)->thread->priority > new_node->thread->priority) 
-    { 
-      new_node->next = (*head_ref); 
-      (*head_ref) = new_node; 
-    } 
-    else
-    { 
-      temp = (*head_ref); 
-      while (temp->next != NULL && temp->next->thread->priority <= new_node->thread->priority) 
-      { 
-        temp = temp->next; 
-      } 
-      new_node->next = temp->next; 
-      temp->next = new_node; 
-    } 
-} 
+void ord_sys_rd_wr(thread_t *t)
+{
+  set_running(NULL);
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
+  temp->io_wait = sim_time();
+}
 
-//borrowed from https://www.geeksforgeeks.org/linked-list-set-2-inserting-a-node/ 
-//then altered for use in this assignment 
-void append(struct node** head_ref, thread_t * t)
+void ord_sysexit(thread_t *t)
 {
-  /* 1. allocate node */
-  struct node* new_node
-      = (struct node*)malloc(sizeof(struct node));
+  set_running(NULL);
 
-  struct node* last = *head_ref; /* used in step 5*/
+  struct record *temp = lookup(t);
+  temp->completion = sim_time();
+  set_ready(temp, 0);
+}
+
+void ord_iocomplete(thread_t *t)
+{
+  heap_push(&ctx->ord_q, t, ACTIVE->key(t));
+  set_ready(lookup(t), 1);
+}
 
-  /* 3. This new node is going to be the last node, so
-        make next of it as NULL*/
-  new_node->next = NULL;
-  new_node->thread = t;
-  new_node->quantum_ct = q_value;
-  new_node->waittime = 0;
-  new_node->turnaround = 0;
+void ord_iostarting(thread_t *t)
+{
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
+  temp->io_start = sim_time();
 
-  /* 4. If the Linked List is empty, then make the new
-        node as head */
-  if (*head_ref == NULL) {
-      *head_ref = new_node;
-      return;
-  }
+  temp->waittime = temp->waittime + (temp->io_start - temp->io_wait - 1);
+}
+
+//FCFS order for the multi-core queues and as the base key of the policies
+//that keep their own queues; the heap hands equal keys back in push order
+unsigned int fcfs_key(thread_t *t)
+{
+  return 0;
+}
 
-  /* 5. Else traverse till the last node */
-  while (last->next != NULL)
-      last = last->next;
+unsigned int sjf_key(thread_t *t)
+{
+  return t->length;
+}
 
-  /* 6. Change the next of last node */
-  last->next = new_node;
+unsigned int srtf_key(thread_t *t)
+{
+  return remaining_time(lookup(t));
+}
 
-  return;
+unsigned int prio_key(thread_t *t)
+{
+  return prio_rank(t);
 }
 
-//borrowed from https://www.geeksforgeeks.org/implement-a-stack-using-singly-linked-list/
-void pop(struct node** head_ref)
+const char *algorithm_name(int algorithm)
 {
-  struct node *t;
+  if(algorithm < 0 || algorithm >= ALGORITHM_COUNT)
+  {
+    return NULL;
+  }
+  return algorithm_names[algorithm];
+}
 
-  if(*head_ref == NULL)
+int algorithm_by_name(const char *name)
+{
+  for(int i = 0; i < ALGORITHM_COUNT; i++)
   {
-    return;
+    if(strcmp(algorithm_names[i], name) == 0)
+    {
+      return i;
+    }
   }
+  return -1;
+}
 
-  
-  t = (*head_ref)->next;
-  (*head_ref) = NULL;
-  (*head_ref) = t;
-  
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+/*= = = = = = = = = = = = = = = = = MLFQ FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void mlfq_sysready()
+{
+  if(sim_time() > 0 && sim_time() % MLFQ_BOOST == 0)
+  {
+    mlfq_boost();
+  }
+
+  if(ctx->running_thread != NULL)
+  {
+    struct record *rec = lookup(ctx->running_thread);
+    int level = mlfq_level(rec);
+    int higher = ctx->mlfq_map & ((1u << level) - 1);
+
+    //burned the whole quantum: demote; a higher level has work: preempt
+    if(ctx->mlfq_left <= 0 || higher)
+    {
+      if(ctx->mlfq_left <= 0 && level < MLFQ_LEVELS - 1)
+      {
+        level++;
+      }
+      if(ctx->mlfq_left <= 0)
+      {
+        COUNT(rotations);
+      }
+      else
+      {
+        COUNT(preemptions);
+      }
+      set_running(NULL);
+      mlfq_push(rec, level);
+    }
+  }
+
+  if(ctx->running_thread == NULL && ctx->mlfq_map != 0)
+  {
+    int level = __builtin_ctz(ctx->mlfq_map);
+    thread_t *next = fifo_pop(&ctx->mlfq_q[level]);
+    if(ctx->mlfq_q[level].first == NULL)
+    {
+      ctx->mlfq_map &= ~(1u << level);
+    }
+    ctx->mlfq_left = ctx->q_value << level;
+    set_running(next);
+    dispatch(next);
+    set_ready(lookup(next), 0);
+  }
+
+  if(ctx->running_thread != NULL)
+  {
+    ctx->mlfq_left--;
+    ctx->level_ticks[mlfq_level(lookup(ctx->running_thread))]++;
+  }
+}
+
+void mlfq_sysexec(thread_t *t)
+{
+  struct record *temp = track(t);
+  temp->arrival = sim_time();
+  temp->level_epoch = ctx->boost_epoch;
+  mlfq_push(temp, 0);
+}
+
+void mlfq_sys_rd_wr(thread_t *t)
+{
+  set_running(NULL);
+  struct record *temp = lookup(t);
+  set_ready(temp, 0);
+  temp->io_wait = sim_time();
+}
+
+//gave up the CPU for I/O before its quantum ran out, move up a level
+void mlfq_iocomplete(thread_t *t)
+{
+  struct record *rec = lookup(t);
+  int level = mlfq_level(rec);
+  mlfq_push(rec, level > 0 ? level - 1 : 0);
+}
+
+void mlfq_push(struct record *rec, int level)
+{
+  rec->level = level;
+  rec->level_epoch = ctx->boost_epoch;
+  fifo_push(&ctx->mlfq_q[level], rec->thread, 0);
+  ctx->mlfq_map |= 1u << level;
+  ctx->level_entries[level]++;
+  set_ready(rec, 1);
+}
+
+//a level recorded before the last boost is stale, the thread is back on top
+int mlfq_level(struct record *rec)
+{
+  return rec->level_epoch == ctx->boost_epoch ? rec->level : 0;
+}
+
+//periodic aging: splice every level onto the top one, O(levels)
+void mlfq_boost()
+{
+  for(int level = 1; level < MLFQ_LEVELS; level++)
+  {
+    fifo_splice(&ctx->mlfq_q[0], &ctx->mlfq_q[level]);
+  }
+  ctx->mlfq_map = ctx->mlfq_q[0].first != NULL;
+  ctx->boost_epoch++;
+}
+
+unsigned int mlfq_levels()
+{
+  return MLFQ_LEVELS;
+}
+
+void mlfq_stats(unsigned int level, level_stats_t *stats)
+{
+  stats->level = level;
+  stats->quantum = ctx->q_value << level;
+  stats->ticks = ctx->level_ticks[level];
+  stats->entries = ctx->level_entries[level];
+}
+
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+/*= = = = = = = = = = = = = = = = = CFS FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void cfs_sysready()
+{
+  if(ctx->running_thread != NULL && !rb_empty(&ctx->cfs_q))
+  {
+    struct record *rec = lookup(ctx->running_thread);
+    if(tick_clock() - rec->run_start >= CFS_GRANULARITY && live_vruntime(rec) > rb_min_key(&ctx->cfs_q)
+       && worth_switching(ctx->running_thread))
+    {
+      COUNT(preemptions);
+      set_running(NULL);
+      cfs_push(rec);
+    }
+  }
+
+  if(ctx->running_thread == NULL && !rb_empty(&ctx->cfs_q))
+  {
+    thread_t *next = rb_pop(&ctx->cfs_q);
+    set_running(next);
+    dispatch(next);
+    set_ready(lookup(next), 0);
+  }
+
+  //min_vruntime only moves forward, it is where new and woken threads start
+  unsigned long floor = ctx->min_vruntime;
+  if(ctx->running_thread != NULL)
+  {
+    floor = live_vruntime(lookup(ctx->running_thread));
+  }
+  if(!rb_empty(&ctx->cfs_q) && (ctx->running_thread == NULL || rb_min_key(&ctx->cfs_q) < floor))
+  {
+    floor = rb_min_key(&ctx->cfs_q);
+  }
+  if(floor > ctx->min_vruntime)
+  {
+    ctx->min_vruntime = floor;
+  }
+}
+
+void cfs_sysexec(thread_t *t)
+{
+  struct record *temp = track(t);
+  temp->arrival = sim_time();
+  cfs_push(temp);
+}
+
+void cfs_iocomplete(thread_t *t)
+{
+  cfs_push(lookup(t));
+}
+
+//a thread never enters behind min_vruntime, so sleeping earns no credit
+void cfs_push(struct record *rec)
+{
+  if(rec->vruntime < ctx->min_vruntime)
+  {
+    rec->vruntime = ctx->min_vruntime;
+  }
+  rb_insert(&ctx->cfs_q, rec->thread, rec->vruntime);
+  set_ready(rec, 1);
+}
+
+//CFS load weights for nice 0..19, priority 0 is the heaviest
+unsigned int weight(thread_t *t)
+{
+  static const unsigned int weights[] = {
+    1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45, 36, 29, 23, 18, 15
+  };
+  return weights[t->priority < 20 ? t->priority : 19];
+}
+
+//virtual runtime as of now, including the running thread's current stint
+unsigned long live_vruntime(struct record *rec)
+{
+  if(rec->thread == ctx->running_thread)
+  {
+    return rec->vruntime + (unsigned long)(tick_clock() - rec->run_start) * NICE_0_LOAD / weight(rec->thread);
+  }
+  return rec->vruntime;
+}
+
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+/*= = = = = = = = = = = = = = = = = REAL-TIME FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void rt_sysexec(thread_t *t)
+{
+  struct record *temp = track(t);
+  temp->arrival = sim_time();
+  temp->remaining = t->length;
+  rt_admit(temp);
+
+  heap_push(&ctx->ord_q, t, ACTIVE->key(t));
+  set_ready(temp, 1);
+}
+
+void rt_sysexit(thread_t *t)
+{
+  ord_sysexit(t);
+  rt_retire(lookup(t));
+}
+
+//give REC, arriving now, its deadline and admit it if the policy's bound,
+//per CPU, still holds with it
+void rt_admit(struct record *rec)
+{
+  rec->deadline = rec->arrival + ctx->deadline_factor * rec->thread->length;
+
+  //every thread asks for 1/deadline_factor of the CPU
+  double u = 1.0 / ctx->deadline_factor;
+  double bound = 1.0;
+  if((int)ctx->algo_number == RATE_MONOTONIC)
+  {
+    unsigned int n = ctx->rt_running + 1;
+    bound = n * (pow(2.0, 1.0 / n) - 1);
+  }
+  rec->admitted = ctx->rt_utilization + u <= bound * ctx->cpu_total + 1e-9;
+  if(rec->admitted)
+  {
+    ctx->rt_utilization = ctx->rt_utilization + u;
+    ctx->rt_running++;
+    ctx->rt_admitted++;
+  }
+  else
+  {
+    ctx->rt_rejected++;
+  }
+}
+
+//REC has completed, before finish() counts it
+void rt_retire(struct record *rec)
+{
+  if(rec->admitted)
+  {
+    ctx->rt_utilization = ctx->rt_utilization - 1.0 / ctx->deadline_factor;
+    ctx->rt_running--;
+  }
+
+  int lateness = rec->completion - (int)rec->deadline;
+  if(lateness > 0)
+  {
+    ctx->rt_misses++;
+  }
+  //finish() has not counted this thread yet, so finished == 0 means first exit
+  if(ctx->finished == 0 || lateness > ctx->rt_max_lateness)
+  {
+    ctx->rt_max_lateness = lateness;
+  }
+  ctx->rt_lateness_sum = ctx->rt_lateness_sum + lateness;
+}
+
+unsigned int edf_key(thread_t *t)
+{
+  struct record *rec = lookup(t);
+  return rec->admitted ? rec->deadline : RT_BACKGROUND + rec->deadline;
+}
+
+//the period is deadline_factor * length, so the shortest job has the shortest period
+unsigned int rm_key(thread_t *t)
+{
+  struct record *rec = lookup(t);
+  return rec->admitted ? t->length : RT_BACKGROUND + t->length;
+}
+
+void set_deadline_factor(unsigned int factor)
+{
+  ctx->deadline_request = factor;
+}
+
+void rt_stats(rt_stats_t *stats)
+{
+  stats->admitted = ctx->rt_admitted;
+  stats->rejected = ctx->rt_rejected;
+  stats->misses = ctx->rt_misses;
+  stats->max_lateness = ctx->rt_max_lateness;
+  stats->mean_lateness = ctx->finished ? (double)ctx->rt_lateness_sum / ctx->finished : 0;
+}
+
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+/*= = = = = = = = = = = = = = = = = MULTICORE FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void smp_sysready()
+{
+  //the base policies that preempt on their key: priority and the preemptive ordered set
+  int preemptive = ctx->base->sysready == prmtv_prio_sysready || ctx->base->sysready == p_ord_sysready;
+
+  for(unsigned int i = 0; i < ctx->cpu_total; i++)
+  {
+    struct cpu *c = &ctx->cpus[i];
+
+    if(c->running != NULL && !heap_empty(&c->ready))
+    {
+      int expired = ctx->algo_number == ROUND_ROBIN && c->quantum_ct <= 0;
+      if(expired || (preemptive && ctx->base->key(c->running) > heap_peek_key(&c->ready)))
+      {
+        if(expired)
+        {
+          COUNT(rotations);
+        }
+        else
+        {
+          COUNT(preemptions);
+        }
+        thread_t *prev = c->running;
+        heap_push(&c->ready, prev, ctx->base->key(prev));
+        cpu_run(i, NULL);
+        set_ready(lookup(prev), 1);
+      }
+    }
+
+    if(c->running == NULL)
+    {
+      thread_t *next = heap_pop(&c->ready);
+      if(next == NULL)
+      {
+        next = steal(i);
+      }
+      if(next != NULL)
+      {
+        cpu_run(i, next);
+      }
+    }
+
+    cpu_tick(i);
+  }
+}
+
+void smp_sysexec(thread_t *t)
+{
+  struct record *temp = track(t);
+  temp->arrival = sim_time();
+  temp->remaining = t->length;
+  if(ctx->base->sysexec == rt_sysexec)
+  {
+    rt_admit(temp);
+  }
+
+  heap_push(&ctx->cpus[least_loaded()].ready, t, ctx->base->key(t));
+  set_ready(temp, 1);
+}
+
+//without set_cpu_dispatch() only CPU 0's thread is known to the simulator,
+//so only it does I/O or exits here
+void smp_sys_rd_wr(thread_t *t)
+{
+  struct record *temp = lookup(t);
+  cpu_leave(temp);
+  set_ready(temp, 0);
+  temp->io_wait = sim_time();
+}
+
+void smp_sysexit(thread_t *t)
+{
+  struct record *temp = lookup(t);
+  cpu_leave(temp);
+  temp->completion = sim_time();
+  set_ready(temp, 0);
+  if(ctx->base->sysexec == rt_sysexec)
+  {
+    rt_retire(temp);
+  }
+}
+
+void smp_iocomplete(thread_t *t)
+{
+  heap_push(&ctx->cpus[least_loaded()].ready, t, ctx->base->key(t));
+  set_ready(lookup(t), 1);
+}
+
+//put T on CPU I, or take CPU I's thread off it when T is NULL
+void cpu_run(unsigned int i, thread_t *t)
+{
+  struct cpu *c = &ctx->cpus[i];
+  c->running = t;
+  c->quantum_ct = t != NULL && ctx->algo_number == ROUND_ROBIN ? rr_quantum(t) : (int)ctx->q_value;
+
+  if(i == 0)
+  {
+    set_running(t);
+  }
+  if(t != NULL)
+  {
+    c->dispatches++;
+    struct record *rec = lookup(t);
+    rec->cpu = i;
+    set_ready(rec, 0);
+    if(i == 0)
+    {
+      dispatch(t);
+    }
+    else if(ctx->cpu_dispatch != NULL)
+    {
+      ctx->cpu_dispatch(i, t);
+    }
+  }
+}
+
+//REC's thread gave up its CPU in sys_read(), sys_write() or sys_exit()
+void cpu_leave(struct record *rec)
+{
+  if(ctx->cpus[rec->cpu].running == rec->thread)
+  {
+    cpu_run(rec->cpu, NULL);
+  }
+}
+
+//CPU I executes this tick; the stand-in CPUs also retire finished threads
+void cpu_tick(unsigned int i)
+{
+  struct cpu *c = &ctx->cpus[i];
+  if(c->running == NULL)
+  {
+    return;
+  }
+
+  c->quantum_ct--;
+  if(i == 0)
+  {
+    return;
+  }
+
+  c->busy++;
+  struct record *rec = lookup(c->running);
+  rec->remaining--;
+  rec->cpu_time++;
+  if(rec->remaining <= 0 && ctx->cpu_dispatch == NULL)
+  {
+    rec->completion = sim_time();
+    rec->done = 1;
+    c->running = NULL;
+    if(ctx->base->sysexec == rt_sysexec)
+    {
+      rt_retire(rec);
+    }
+    finish(rec);
+  }
+}
+
+unsigned int least_loaded()
+{
+  unsigned int best = 0;
+  unsigned int best_load = ctx->cpus[0].ready.size + (ctx->cpus[0].running != NULL);
+  for(unsigned int i = 1; i < ctx->cpu_total; i++)
+  {
+    unsigned int load = ctx->cpus[i].ready.size + (ctx->cpus[i].running != NULL);
+    if(load < best_load)
+    {
+      best = i;
+      best_load = load;
+    }
+  }
+  return best;
+}
+
+//take the next thread from the longest ready queue other than CPU I's
+thread_t *steal(unsigned int i)
+{
+  unsigned int victim = i;
+  unsigned int most = 0;
+  for(unsigned int j = 0; j < ctx->cpu_total; j++)
+  {
+    if(j != i && ctx->cpus[j].ready.size > most)
+    {
+      victim = j;
+      most = ctx->cpus[j].ready.size;
+    }
+  }
+
+  if(victim == i)
+  {
+    return NULL;
+  }
+  ctx->cpus[i].steals++;
+  return heap_pop(&ctx->cpus[victim].ready);
+}
+
+void set_cpus(unsigned int count)
+{
+  ctx->cpu_request = count < 1 ? 1 : count > MAX_CPUS ? MAX_CPUS : count;
+}
+
+void set_cpu_dispatch(void (*dispatch)(unsigned int cpu, thread_t *t))
+{
+  ctx->cpu_dispatch = dispatch;
+}
+
+unsigned int cpu_count()
+{
+  return ctx->cpu_total ? ctx->cpu_total : 1;
+}
+
+//CPU 0's busy time is charged by set_running(), add the stint in progress
+void cpu_stats(unsigned int cpu, cpu_stats_t *stats)
+{
+  struct cpu *c = &ctx->cpus[cpu];
+  stats->cpu = cpu;
+  stats->busy_time = c->busy;
+  stats->dispatches = c->dispatches;
+  stats->steals = c->steals;
+  if(cpu == 0 && ctx->running_thread != NULL)
+  {
+    stats->busy_time = stats->busy_time + (tick_clock() - lookup(ctx->running_thread)->run_start);
+  }
+  stats->utilization = sim_time() ? (double)stats->busy_time / sim_time() : 0;
+}
+
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+/*= = = = = = = = = = = = = = = = = THREAD TABLE FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+//add T to the table, doubling it until tid T fits; new slots are zeroed
+struct record *track(thread_t *t)
+{
+  if(t->tid >= ctx->table_size)
+  {
+    unsigned int new_size = ctx->table_size ? ctx->table_size : 16;
+    while(new_size <= t->tid)
+    {
+      new_size = new_size * 2;
+    }
+    ctx->thread_table = realloc(ctx->thread_table, sizeof(struct record) * new_size);
+    for(unsigned int i = ctx->table_size; i < new_size; i++)
+    {
+      ctx->thread_table[i] = (struct record){0};
+    }
+    ctx->table_size = new_size;
+  }
+
+  struct record *rec = &ctx->thread_table[t->tid];
+  rec->thread = t;
+  rec->wait_start = -1;
+  rec->remaining = t->length;
+  rec->burst_avg = ctx->q_value * 16;
+  return rec;
+}
+
+//T must have been through track() in this simulation
+struct record *lookup(thread_t *t)
+{
+  assert(t->tid < ctx->table_size && ctx->thread_table[t->tid].thread == t);
+  return &ctx->thread_table[t->tid];
+}
+
+/*= = = = = = = = = = = = = = = = = CONTEXT FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+struct context *context_create()
+{
+  struct context *c = calloc(1, sizeof(struct context));
+  c->active = &policies[FIRST_COME_FIRST_SERVED];
+  c->last_ready = -1;
+  return c;
+}
+
+void context_use(struct context *c)
+{
+  ctx = c ? c : &fallback;
+  pool_use(&ctx->pool);
+}
+
+//forget the last simulation's threads and totals; queue, heap and table
+//storage is kept for the next one. set_cpus(), set_aging(), 
+//set_deadline_factor(), set_switch_cost(), set_quantum_mode() and
+//set_cpu_dispatch() requests are not part of a simulation and survive
+void context_reset(struct context *c)
+{
+  drop_queues(c);
+  if(c->trace != NULL)
+  {
+    trace_close(c->trace);
+    c->trace = NULL;
+  }
+  c->count = 0;
+  c->finished = 0;
+  c->turnaround_sum = 0;
+  c->waiting_sum = 0;
+  c->rate_sum = 0;
+  c->max_waiting = 0;
+  c->running_thread = NULL;
+
+  c->mlfq_left = 0;
+  c->boost_epoch = 0;
+  memset(c->level_ticks, 0, sizeof(c->level_ticks));
+  memset(c->level_entries, 0, sizeof(c->level_entries));
+  c->min_vruntime = 0;
+
+  c->rt_running = 0;
+  c->rt_utilization = 0;
+  c->rt_admitted = 0;
+  c->rt_rejected = 0;
+  c->rt_misses = 0;
+  c->rt_max_lateness = 0;
+  c->rt_lateness_sum = 0;
+
+  for(unsigned int i = 0; i < MAX_CPUS; i++)
+  {
+    c->cpus[i].running = NULL;
+    c->cpus[i].ready.size = 0;
+    c->cpus[i].quantum_ct = 0;
+    c->cpus[i].busy = 0;
+    c->cpus[i].dispatches = 0;
+    c->cpus[i].steals = 0;
+  }
+
+  if(c->thread_table != NULL)
+  {
+    memset(c->thread_table, 0, sizeof(struct record) * c->table_size);
+  }
+  c->last_ready = -1;
+  c->waiting = 0;
+  c->on_cpu = NULL;
+  c->dispatches = 0;
+  c->elided = 0;
+  c->late_starts = 0;
+  c->deferred = 0;
+  c->io_count = 0;
+  c->io_queued = 0;
+  c->io_delay_sum = 0;
+  c->io_max_delay = 0;
+  c->io_busy = 0;
+  c->bursts = 0;
+  c->burst_sum = 0;
+  c->quanta = 0;
+  c->quantum_sum = 0;
+  memset(&c->counters, 0, sizeof(c->counters));
+}
+
+void context_destroy(struct context *c)
+{
+  if(c == NULL)
+  {
+    return;
+  }
+
+  drop_queues(c);
+  heap_free(&c->prio_q.overflow);
+  heap_free(&c->ord_q);
+  rb_free(&c->cfs_q);
+  for(unsigned int i = 0; i < MAX_CPUS; i++)
+  {
+    heap_free(&c->cpus[i].ready);
+  }
+  free(c->wait_samples);
+  free(c->thread_table);
+  if(c->trace != NULL)
+  {
+    trace_close(c->trace);
+  }
+  free(c->trace_path);
+  free(c->counters_path);
+
+  if(ctx == c)
+  {
+    context_use(NULL);
+  }
+  if(c == &fallback)
+  {
+    *c = (struct context){ .active = &policies[FIRST_COME_FIRST_SERVED], .last_ready = -1 };
+  }
+  else
+  {
+    free(c);
+  }
+}
+
+//empty every ready queue of C and hand back every node at once
+void drop_queues(struct context *c)
+{
+  c->rr_q = (struct fifo){0};
+  c->fcfs_q = (struct fifo){0};
+  c->prio_q.map = 0;
+  c->prio_q.base = 0;
+  memset(c->prio_q.bucket, 0, sizeof(c->prio_q.bucket));
+  c->prio_q.overflow.size = 0;
+  c->ord_q.size = 0;
+  memset(c->mlfq_q, 0, sizeof(c->mlfq_q));
+  c->mlfq_map = 0;
+  while(!rb_empty(&c->cfs_q))
+  {
+    rb_pop(&c->cfs_q);
+  }
+  pool_reset(&c->pool);
+}
+
+/*= = = = = = = = = = = = = = = = = TRACE FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void set_trace(const char *path)
+{
+  free(ctx->trace_path);
+  ctx->trace_path = path ? strdup(path) : NULL;
+  ctx->trace_set = 1;
+}
+
+/*= = = = = = = = = = = = = = = = = COUNTER FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+void set_counters(const char *path)
+{
+  free(ctx->counters_path);
+  ctx->counters_path = path ? strdup(path) : NULL;
+  ctx->counters_set = 1;
+}
+
+#ifdef INSTRUMENT
+//once per sim_ready(), after the policy has picked what runs this tick
+void count_tick()
+{
+  counters_t *c = &ctx->counters;
+  c->ticks++;
+  c->ready_sum = c->ready_sum + ctx->waiting;
+  c->ready_max = ctx->waiting > c->ready_max ? ctx->waiting : c->ready_max;
+  SAMPLE(ready_hist, ctx->waiting);
+  if(ctx->cpu_total > 1)
+  {
+    for(unsigned int i = 0; i < ctx->cpu_total; i++)
+    {
+      c->idle_ticks = c->idle_ticks + (ctx->cpus[i].running == NULL);
+    }
+  }
+  else
+  {
+    c->idle_ticks = c->idle_ticks + (ctx->running_thread == NULL);
+  }
+}
+
+void write_counters()
+{
+  if(ctx->counters_path == NULL)
+  {
+    return;
+  }
+  FILE *file = fopen(ctx->counters_path, "a");
+  if(file != NULL)
+  {
+    counters_write(file, &ctx->counters, algorithm_name(ctx->algo_number), ctx->q_value, ctx->count);
+    fclose(file);
+  }
+}
+#endif
+
+/*= = = = = = = = = = = = = = = = = DISPATCH FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+//every dispatch goes through here so it can be traced, and so one that would
+//not change what the CPU runs never reaches the simulator
+void dispatch(thread_t *t)
+{
+  if(t == ctx->on_cpu)
+  {
+    ctx->elided++;
+    COUNT(elided);
+    return;
+  }
+
+  TRACE(TRACE_DISPATCH, t);
+  if(t == NULL)
+  {
+    COUNT(idle_dispatches);
+  }
+  else
+  {
+    //only a new thread onto an idle CPU starts in the tick it is dispatched
+    //in, see simulator.h; anything else starts in the next
+    struct record *rec = lookup(t);
+    if(ctx->on_cpu != NULL || rec->arrival != sim_time() || rec->cpu_time > 0)
+    {
+      ctx->late_starts++;
+    }
+    rec->deferred = 0;
+    if(ctx->on_cpu != NULL)
+    {
+      COUNT(switches);
+    }
+    ctx->dispatches++;
+    COUNT(dispatches);
+  }
+  ctx->on_cpu = t;
+  sim_dispatch(t);
+}
+
+//T gave up the CPU in sys_read(), sys_write() or sys_exit()
+void leave_cpu(thread_t *t)
+{
+  if(ctx->on_cpu == t)
+  {
+    ctx->on_cpu = NULL;
+  }
+}
+
+//with a switch cost set, a thread due to finish within that many ticks keeps
+//the CPU rather than being preempted or rotated out; a heuristic against
+//switches that buy little, nothing here charges for a switch
+int worth_switching(thread_t *running)
+{
+  struct record *rec = lookup(running);
+  if(ctx->switch_cost == 0 || remaining_time(rec) > (int)ctx->switch_cost)
+  {
+    return 1;
+  }
+
+  //asked again every tick it keeps the CPU, counted once until it is next dispatched
+  if(!rec->deferred)
+  {
+    rec->deferred = 1;
+    ctx->deferred++;
+  }
+  return 0;
+}
+
+void set_switch_cost(unsigned int ticks)
+{
+  ctx->switch_cost_request = ticks;
+}
+
+void switch_stats(switch_stats_t *stats)
+{
+  stats->dispatches = ctx->dispatches;
+  stats->elided = ctx->elided;
+  stats->late_starts = ctx->late_starts;
+  stats->deferred = ctx->deferred;
+}
+
+/*= = = = = = = = = = = = = = = = = BURST FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+//T's CPU burst ends in sys_read(), sys_write() or sys_exit(), however many
+//times it was put back on the ready queue since its last one; fold it into
+//the moving averages with a weight of 1/4
+void end_burst(thread_t *t)
+{
+  struct record *rec = lookup(t);
+  int used = rec->cpu_time + (t == ctx->running_thread ? tick_clock() - rec->run_start : 0);
+  int burst = used - rec->burst_base;
+  rec->burst_base = used;
+  if(burst <= 0)
+  {
+    return;
+  }
+
+  ctx->bursts++;
+  ctx->burst_sum = ctx->burst_sum + burst;
+  ctx->burst_avg = ctx->burst_avg + (burst * 16 - (int)ctx->burst_avg) / 4;
+  rec->burst_avg = rec->burst_avg + (burst * 16 - (int)rec->burst_avg) / 4;
+}
+
+/*= = = = = = = = = = = = = = = = = I/O FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+//T asked for I/O in sys_read() or sys_write(); it can start from the next tick
+void io_asked(thread_t *t)
+{
+  COUNT(io_waits);
+  lookup(t)->io_asked = sim_time();
+  ctx->io_queued++;
+}
+
+//a device took T, any ticks since the first it could have are queueing delay
+void io_began(thread_t *t)
+{
+  struct record *rec = lookup(t);
+  int delay = sim_time() - rec->io_asked - 1;
+  delay = delay < 0 ? 0 : delay;
+  rec->io_began = sim_time();
+  rec->io_delay = rec->io_delay + delay;
+  ctx->io_delay_sum = ctx->io_delay_sum + delay;
+  ctx->io_max_delay = (unsigned int)delay > ctx->io_max_delay ? (unsigned int)delay : ctx->io_max_delay;
+  ctx->io_queued--;
+}
+
+//the tick an I/O starts in is its first, and the one it completes in its last
+void io_done(thread_t *t)
+{
+  struct record *rec = lookup(t);
+  ctx->io_count++;
+  ctx->io_busy = ctx->io_busy + (sim_time() - rec->io_began + 1);
+  COUNT_ADD(io_ticks, sim_time() - rec->io_asked);
+  SAMPLE(io_hist, sim_time() - rec->io_asked);
+}
+
+void io_stats(io_stats_t *stats)
+{
+  stats->ios = ctx->io_count;
+  stats->queued = ctx->io_queued;
+  stats->delay_sum = ctx->io_delay_sum;
+  stats->max_delay = ctx->io_max_delay;
+  stats->mean_delay = ctx->io_count ? (double)ctx->io_delay_sum / ctx->io_count : 0;
+  stats->busy = ctx->io_busy;
+  stats->utilization = sim_time() > 0 ? (double)ctx->io_busy / sim_time() : 0;
+}
+
+/*= = = = = = = = = = = = = = = = = TIME ACCOUNTING FUNCTIONS = = = = = = = = = = = = = = = = =*/
+
+//number of sim_ready() calls made so far; a change before this tick's
+//sim_ready() is charged from this tick, a change after it from the next.
+//waiting and CPU time are both measured on this clock
+int tick_clock()
+{
+  return sim_time() + (ctx->last_ready == sim_time());
+}
+
+//a thread waits while it is ready, not running and not done; open or close
+//its waiting interval whenever one of those changes
+void account(struct record *rec)
+{
+  int waiting = rec->ready_q == 1 && rec->thread != ctx->running_thread && rec->done != 1;
+
+  if(waiting && rec->wait_start < 0)
+  {
+    rec->wait_start = tick_clock();
+    ctx->waiting++;
+  }
+  else if(!waiting && rec->wait_start >= 0)
+  {
+    rec->waittime = rec->waittime + (tick_clock() - rec->wait_start);
+    rec->wait_start = -1;
+    ctx->waiting--;
+  }
+}
+
+void set_ready(struct record *rec, int ready_q)
+{
+  rec->ready_q = ready_q;
+  account(rec);
+}
+
+//CPU time is charged to the thread leaving the CPU, so nothing needs
+//updating while a thread runs
+void set_running(thread_t *t)
+{
+  thread_t *prev = ctx->running_thread;
+  if(prev == t)
+  {
+    return;
+  }
+
+  ctx->running_thread = t;
+  if(prev != NULL)
+  {
+    struct record *rec = lookup(prev);
+    int stint = tick_clock() - rec->run_start;
+    rec->remaining = rec->remaining - stint;
+    rec->cpu_time = rec->cpu_time + stint;
+    rec->vruntime = rec->vruntime + (unsigned long)stint * NICE_0_LOAD / weight(prev);
+    ctx->cpus[0].busy = ctx->cpus[0].busy + stint;
+    account(rec);
+  }
+  if(t != NULL)
+  {
+    struct record *rec = lookup(t);
+    rec->run_start = tick_clock();
+    if(ctx->cpu_total <= 1)
+    {
+      ctx->cpus[0].dispatches++;
+    }
+    account(rec);
+  }
+}
+
+//remaining burst as of now, including the running thread's current stint
+int remaining_time(struct record *rec)
+{
+  if(rec->thread == ctx->running_thread)
+  {
+    return rec->remaining - (tick_clock() - rec->run_start);
+  }
+  return rec->remaining;
+}
+
+/*= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =*/
+
+
+void turnaround(struct record *rec)
+{
+  rec->turnaround = rec->completion - rec->arrival + 1;
+}
+
+//REC has exited and its waiting interval is closed, fold it into the totals
+void finish(struct record *rec)
+{
+  turnaround(rec);
+  ctx->finished++;
+  ctx->turnaround_sum = ctx->turnaround_sum + rec->turnaround;
+  ctx->waiting_sum = ctx->waiting_sum + rec->waittime;
+
+  if(rec->turnaround > 0)
+  {
+    rec->rate = (double)rec->cpu_time * NICE_0_LOAD / weight(rec->thread) / rec->turnaround;
+  }
+  ctx->rate_sum = ctx->rate_sum + rec->rate;
+
+  if(ctx->finished > ctx->wait_sample_cap)
+  {
+    ctx->wait_sample_cap = ctx->wait_sample_cap ? ctx->wait_sample_cap * 2 : 64;
+    ctx->wait_samples = realloc(ctx->wait_samples, sizeof(unsigned int) * ctx->wait_sample_cap);
+  }
+  ctx->wait_samples[ctx->finished - 1] = rec->waittime;
+  if(rec->waittime > ctx->max_waiting)
+  {
+    ctx->max_waiting = rec->waittime;
+  }
+}
+
+int thread_stats(unsigned int tid, thread_stats_t *stats)
+{
+  if(tid >= ctx->table_size || ctx->thread_table[tid].thread == NULL || ctx->finished == 0)
+  {
+    return -1;
+  }
+
+  //turnaround is set when the thread exits and is at least 1
+  struct record *rec = &ctx->thread_table[tid];
+  if(rec->turnaround == 0)
+  {
+    return -1;
+  }
+  stats->tid = tid;
+  stats->waiting_time = rec->waittime;
+  stats->turnaround_time = rec->turnaround;
+  stats->cpu_time = rec->cpu_time;
+  stats->fairness = rec->rate - ctx->rate_sum / ctx->finished;
+  stats->deadline = rec->deadline;
+  stats->lateness = rec->deadline ? rec->completion - (int)rec->deadline : 0;
+  stats->io_delay = rec->io_delay;
+  return 0;
+}
+
+//quickselect the k-th smallest sample, k chosen so PERCENT of samples are at or below it
+unsigned int waiting_percentile(double percent)
+{
+  if(ctx->finished == 0)
+  {
+    return 0;
+  }
+
+  int n = ctx->finished;
+  int k = (int)(percent / 100.0 * n + 0.999999) - 1;
+  k = k < 0 ? 0 : k >= n ? n - 1 : k;
+
+  unsigned int *a = malloc(sizeof(unsigned int) * n);
+  memcpy(a, ctx->wait_samples, sizeof(unsigned int) * n);
+  int lo = 0;
+  int hi = n - 1;
+  while(lo < hi)
+  {
+    //Lomuto partition around the middle element
+    int mid = lo + (hi - lo) / 2;
+    unsigned int pivot = a[mid];
+    a[mid] = a[hi];
+    a[hi] = pivot;
+    int store = lo;
+    for(int i = lo; i < hi; i++)
+    {
+      if(a[i] < pivot)
+      {
+        unsigned int tmp = a[i];
+        a[i] = a[store];
+        a[store] = tmp;
+        store++;
+      }
+    }
+    a[hi] = a[store];
+    a[store] = pivot;
+
+    if(k == store)
+    {
+      break;
+    }
+    else if(k < store)
+    {
+      hi = store - 1;
+    }
+    else
+    {
+      lo = store + 1;
+    }
+  }
+
+  unsigned int result = a[k];
+  free(a);
+  return result;
+}
+
+void snapshot(snapshot_t *snap)
+{
+  snap->time = sim_time();
+  snap->thread_count = ctx->count;
+  snap->finished = ctx->finished;
+  snap->turnaround_sum = ctx->turnaround_sum;
+  snap->waiting_sum = ctx->waiting_sum;
+  snap->mean_turnaround = ctx->finished ? (double)ctx->turnaround_sum / ctx->finished : 0;
+  snap->mean_waiting = ctx->finished ? (double)ctx->waiting_sum / ctx->finished : 0;
+  snap->max_waiting = ctx->max_waiting;
 }
@@ -0,0 +1,61 @@
+/**
+ * Multi-core mode. With more than one CPU the policy runs on per-CPU ready
+ * queues ordered by its key: new and returning threads go to the least
+ * loaded CPU, and a CPU whose queue runs dry steals from the busiest one.
+ * ROUND_ROBIN rotates a CPU's thread out at the end of its quantum, and
+ * PREEMPTIVE_PRIORITY, the preemptive shortest job and remaining time
+ * policies, EARLIEST_DEADLINE_FIRST and RATE_MONOTONIC preempt it for a
+ * better key on the same CPU. The real-time admission bound is per CPU, so
+ * N CPUs admit N times the utilization. MULTILEVEL_FEEDBACK_QUEUE and
+ * COMPLETELY_FAIR have no multi-core form; scheduler() says so on stderr
+ * once and runs them on one CPU.
+ *
+ * CPU 0 is the simulator's CPU and is driven through sim_dispatch(). The 
+ * simulator has no other CPUs, so unless set_cpu_dispatch() hands them to
+ * the caller, CPUs 1..N-1 are run by a local stand-in dispatcher that
+ * executes a thread's remaining burst (thread_t::length less CPU time
+ * already used) one tick per sim_ready(), with no further I/O. Threads the
+ * stand-in finishes never reach sys_exit(), so the simulator itself reports
+ * them as not exited; the stand-in engine in tools/ runs every CPU.
+ */
+#ifndef __SMP_H
+#define __SMP_H
+
+#include "simulator.h"
+
+#define MAX_CPUS 64
+
+/**
+ * Use COUNT CPUs (clamped to 1..MAX_CPUS) for the next call to scheduler().
+ * Without a call the SCHED_CPUS environment variable is used, else 1.
+ */
+void set_cpus(unsigned int count);
+
+/**
+ * Have DISPATCH run CPUs 1..N-1 in place of the stand-in dispatcher.
+ * DISPATCH(CPU, T) puts T on CPU as sim_dispatch() does on CPU 0, and the
+ * caller then runs it and calls sys_read(), sys_write() and sys_exit() for
+ * it as for CPU 0's thread. NULL (the default) goes back to the stand-in.
+ * Like set_cpus() it holds for every later call to scheduler().
+ */
+void set_cpu_dispatch(void (*dispatch)(unsigned int cpu, thread_t *t));
+
+typedef struct __cpu_stats_t {
+  unsigned int cpu;
+  unsigned int busy_time;        // Ticks spent running a thread
+  unsigned int dispatches;       // Threads put on this CPU
+  unsigned int steals;           // Threads taken from another CPU's queue
+  double utilization;            // busy_time / sim_time()
+} cpu_stats_t;
+
+/**
+ * Number of CPUs in use.
+ */
+unsigned int cpu_count();
+
+/**
+ * Fill in STATS for CPU, 0 <= CPU < cpu_count().
+ */
+void cpu_stats(unsigned int cpu, cpu_stats_t *stats);
+
+#endif // __SMP_H
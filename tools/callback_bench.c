@@ -0,0 +1,279 @@
+/**
+ * Per-callback latency: drives the scheduler callbacks directly, without the
+ * simulator or the engine, at a fixed number of live threads, and reports
+ * each callback's cost per policy and depth. See make bench.
+ *
+ *   callback-bench [-a ALGORITHMS] [-d DEPTHS] [-n CYCLES] [-q QUANTUM] [-o CSV]
+ *
+ * ALGORITHMS and DEPTHS are comma separated lists, defaulting to every
+ * algorithm and depths 1,16,256,4096,65536. DEPTH threads are started and
+ * left running untimed, then each of CYCLES timed cycles is two ticks:
+ *
+ *   sim_tick, sys_exec (a new thread), sim_ready, sys_read or sys_write
+ *   (alternately, by the running thread), io_starting (for that thread)
+ *   sim_tick, sim_ready, sys_exit (by the running thread), io_complete
+ *
+ * so one thread arrives and one exits per cycle and DEPTH threads stay live,
+ * one of them on the CPU and one at most on the I/O device; the thread table
+ * grows to DEPTH + CYCLES. Threads are long enough never to run out.
+ *
+ * Every call is timed on its own with CLOCK_MONOTONIC, less the clock's own
+ * cost measured up front, and reported as mean and percentiles in ns. The
+ * table goes to stdout; with -o the same rows are written to CSV as
+ * algorithm,depth,threads,callback,samples,mean,p50,p90,p99,p999,max.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "scheduler.h"
+#include "algorithms.h"
+
+#define MAX_LIST 64
+#define WARMUP 1000
+
+enum callback {
+  CB_TICK,
+  CB_EXEC,
+  CB_READY,
+  CB_READ,
+  CB_WRITE,
+  CB_IO_STARTING,
+  CB_IO_COMPLETE,
+  CB_EXIT,
+  CB_KINDS
+};
+
+const char *callback_names[] = { "sim_tick", "sys_exec", "sim_ready", "sys_read", "sys_write",
+                                 "io_starting", "io_complete", "sys_exit" };
+
+int now = 0;
+thread_t *running = NULL;
+
+int sim_time()
+{
+  return now;
+}
+
+void sim_dispatch(thread_t *t)
+{
+  running = t;
+}
+
+long clock_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000l + ts.tv_nsec;
+}
+
+//what a back to back pair of clock_ns() costs, taken off every sample
+long overhead = 0;
+
+void calibrate()
+{
+  long best = -1;
+  for(int i = 0; i < 100000; i++)
+  {
+    long start = clock_ns();
+    long end = clock_ns();
+    best = best < 0 || end - start < best ? end - start : best;
+  }
+  overhead = best;
+}
+
+//samples of the callback being timed, SAMPLES[kind][0..used[kind])
+long *samples[CB_KINDS];
+unsigned int used[CB_KINDS];
+
+#define TIMED(kind, call) do {                                 \
+    long start_ = clock_ns();                                  \
+    call;                                                      \
+    long ns_ = clock_ns() - start_ - overhead;                 \
+    if(timing) samples[kind][used[kind]++] = ns_ < 0 ? 0 : ns_; \
+  } while(0)
+
+int parse(char *arg, unsigned int *list, unsigned int *size, int names)
+{
+  *size = 0;
+  for(char *tok = strtok(arg, ","); tok != NULL; tok = strtok(NULL, ","))
+  {
+    int v = names ? algorithm_by_name(tok) : atoi(tok);
+    if(v < 0 || (!names && v == 0) || *size == MAX_LIST)
+    {
+      return -1;
+    }
+    list[(*size)++] = v;
+  }
+  return *size ? 0 : -1;
+}
+
+int by_value(const void *a, const void *b)
+{
+  long x = *(const long *)a;
+  long y = *(const long *)b;
+  return x < y ? -1 : x > y;
+}
+
+//the sample below which FRACTION of them fall, SORTED in ascending order
+long percentile(const long *sorted, unsigned int count, double fraction)
+{
+  unsigned int i = (unsigned int)(fraction * count);
+  return sorted[i < count ? i : count - 1];
+}
+
+void bench(unsigned int algorithm, unsigned int depth, unsigned int cycles, unsigned int quantum, FILE *csv)
+{
+  unsigned int total = depth + WARMUP + cycles;
+  thread_t *threads = calloc(total + 1, sizeof(thread_t));
+  unsigned int seed = algorithm * 7919 + depth;
+  for(unsigned int tid = 1; tid <= total; tid++)
+  {
+    threads[tid].tid = tid;
+    threads[tid].priority = rand_r(&seed) % 5;
+    threads[tid].length = 100000000 + rand_r(&seed) % 1000;
+  }
+
+  now = 0;
+  running = NULL;
+  scheduler(algorithm, quantum);
+  for(unsigned int tid = 1; tid <= depth; tid++)
+  {
+    sys_exec(&threads[tid]);
+  }
+  sim_ready();
+
+  memset(used, 0, sizeof(used));
+  unsigned int next = depth + 1;
+  for(unsigned int c = 0; c < WARMUP + cycles; c++)
+  {
+    int timing = c >= WARMUP;
+    thread_t *t = &threads[next++];
+
+    now++;
+    TIMED(CB_TICK, sim_tick());
+    TIMED(CB_EXEC, sys_exec(t));
+    TIMED(CB_READY, sim_ready());
+    thread_t *io = running;
+    if(c % 2)
+    {
+      TIMED(CB_WRITE, sys_write(io));
+    }
+    else
+    {
+      TIMED(CB_READ, sys_read(io));
+    }
+    TIMED(CB_IO_STARTING, io_starting(io));
+
+    now++;
+    TIMED(CB_TICK, sim_tick());
+    TIMED(CB_READY, sim_ready());
+    TIMED(CB_EXIT, sys_exit(running));
+    TIMED(CB_IO_COMPLETE, io_complete(io));
+  }
+
+  stats_t *s = stats();
+  free(s->tstats);
+  free(s);
+  free(threads);
+
+  for(unsigned int k = 0; k < CB_KINDS; k++)
+  {
+    unsigned int n = used[k];
+    long *v = samples[k];
+    qsort(v, n, sizeof(long), by_value);
+    double mean = 0;
+    for(unsigned int i = 0; i < n; i++)
+    {
+      mean = mean + v[i];
+    }
+    mean = n ? mean / n : 0;
+    long p50 = percentile(v, n, 0.5), p90 = percentile(v, n, 0.9);
+    long p99 = percentile(v, n, 0.99), p999 = percentile(v, n, 0.999);
+    printf("%-12s %6u %-12s %8u %8.1f %6ld %6ld %6ld %6ld %8ld\n", algorithm_name(algorithm), depth,
+           callback_names[k], n, mean, p50, p90, p99, p999, v[n - 1]);
+    if(csv != NULL)
+    {
+      fprintf(csv, "%s,%u,%u,%s,%u,%.1f,%ld,%ld,%ld,%ld,%ld\n", algorithm_name(algorithm), depth, total,
+              callback_names[k], n, mean, p50, p90, p99, p999, v[n - 1]);
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  //it would stand in for every algorithm asked for below
+  if(getenv("SCHED_ALGORITHM") != NULL)
+  {
+    fprintf(stderr, "%s: SCHED_ALGORITHM is set, unset it to run\n", argv[0]);
+    return 2;
+  }
+
+  unsigned int algorithms[MAX_LIST];
+  unsigned int algorithm_count = ALGORITHM_COUNT;
+  for(unsigned int a = 0; a < ALGORITHM_COUNT; a++)
+  {
+    algorithms[a] = a;
+  }
+  unsigned int depths[MAX_LIST] = { 1, 16, 256, 4096, 65536 };
+  unsigned int depth_count = 5;
+  unsigned int cycles = 20000;
+  unsigned int quantum = 4;
+  const char *csv_path = NULL;
+
+  int opt;
+  while((opt = getopt(argc, argv, "a:d:n:q:o:")) != -1)
+  {
+    int bad = 0;
+    switch(opt)
+    {
+      case 'a': bad = parse(optarg, algorithms, &algorithm_count, 1); break;
+      case 'd': bad = parse(optarg, depths, &depth_count, 0); break;
+      case 'n': cycles = atoi(optarg); break;
+      case 'q': quantum = atoi(optarg); break;
+      case 'o': csv_path = optarg; break;
+      default: bad = -1;
+    }
+    if(bad || cycles == 0 || quantum == 0)
+    {
+      fprintf(stderr, "usage: %s [-a ALGORITHMS] [-d DEPTHS] [-n CYCLES] [-q QUANTUM] [-o CSV]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  FILE *csv = NULL;
+  if(csv_path != NULL)
+  {
+    csv = fopen(csv_path, "w");
+    if(csv == NULL)
+    {
+      fprintf(stderr, "callback-bench: cannot write %s\n", csv_path);
+      return 1;
+    }
+    fprintf(csv, "algorithm,depth,threads,callback,samples,mean,p50,p90,p99,p999,max\n");
+  }
+
+  //sim_tick and sim_ready run twice a cycle
+  for(unsigned int k = 0; k < CB_KINDS; k++)
+  {
+    samples[k] = malloc(sizeof(long) * 2 * cycles);
+  }
+  calibrate();
+  printf("clock overhead %ld ns, subtracted\n", overhead);
+  printf("%-12s %6s %-12s %8s %8s %6s %6s %6s %6s %8s\n", "algorithm", "depth", "callback", "samples",
+         "mean", "p50", "p90", "p99", "p99.9", "max");
+  for(unsigned int a = 0; a < algorithm_count; a++)
+  {
+    for(unsigned int d = 0; d < depth_count; d++)
+    {
+      bench(algorithms[a], depths[d], cycles, quantum, csv);
+    }
+  }
+
+  if(csv != NULL)
+  {
+    fclose(csv);
+  }
+  return 0;
+}
@@ -0,0 +1,367 @@
+/**
+ * See engine.h.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "smp.h"
+
+//a job's progress, indexed by tid - 1
+typedef struct state {
+    thread_t thread;
+    job_t * job;
+    unsigned int ran;
+    unsigned int io_done;
+    int io_queued;
+}state;
+
+static __thread struct state *threads = NULL;
+static __thread int now = 0;
+
+//the thread on each CPU, which runs one tick per cpu_step(); CPU 0 is
+//sim_dispatch()'s and the rest set_cpu_dispatch()'s
+static __thread thread_t * on_cpu[MAX_CPUS];
+static __thread unsigned int cpus = 1;
+
+//ticks each switch costs; while one is made the CPU runs nothing, and from
+//the tick after the dispatch sim_ready() is held back as long
+static __thread unsigned int switch_cost = 0;
+static __thread unsigned int switching = 0;
+static __thread unsigned int held = 0;
+
+//an I/O device and its queue, a min-heap on the policy's key then order
+typedef struct waiter {
+    unsigned long key;
+    thread_t * thread;
+}waiter;
+
+typedef struct device {
+    thread_t * on_device;
+    struct waiter *queue;
+    unsigned int size;
+    unsigned int cap;
+}device;
+
+static __thread struct device devices[MAX_DEVICES];
+static __thread unsigned int device_count = 1;
+static __thread enum io_policy device_policy = IO_FIFO;
+
+//threads that asked for I/O this tick, at most one per CPU, queued at the end of it
+static __thread thread_t * asked[MAX_CPUS];
+static __thread unsigned int asked_count = 0;
+static __thread unsigned long asked_seq = 0;
+
+static __thread run_t counters;
+
+typedef struct arrival {
+    unsigned int tick;
+    unsigned int index;
+}arrival;
+
+static int by_arrival(const void *a, const void *b)
+{
+  const struct arrival *x = a;
+  const struct arrival *y = b;
+  if(x->tick != y->tick)
+  {
+    return x->tick < y->tick ? -1 : 1;
+  }
+  return x->index < y->index ? -1 : x->index > y->index;
+}
+
+int sim_time()
+{
+  return now;
+}
+
+static void cpu_dispatch(unsigned int cpu, thread_t *t)
+{
+  counters.dispatches++;
+  if(t == on_cpu[cpu])
+  {
+    return;
+  }
+  if(t != NULL && on_cpu[cpu] != NULL)
+  {
+    counters.switches++;
+    if(cpus == 1)
+    {
+      switching = switch_cost;
+      held = switch_cost;
+    }
+  }
+  on_cpu[cpu] = t;
+}
+
+void sim_dispatch(thread_t *t)
+{
+  cpu_dispatch(0, t);
+}
+
+void jobs_random(job_t *jobs, unsigned int count, unsigned int seed, unsigned int spacing)
+{
+  for(unsigned int i = 0; i < count; i++)
+  {
+    job_t *j = &jobs[i];
+    j->arrival = i * spacing + rand_r(&seed) % 10;
+    j->priority = rand_r(&seed) % 5;
+    j->length = 1 + rand_r(&seed) % 20;
+    j->io_start = 0;
+    j->io_burst = 0;
+    j->write = 0;
+    j->device = 0;
+    if(j->length > 1 && rand_r(&seed) % 3 == 0)
+    {
+      j->io_start = 1 + rand_r(&seed) % (j->length - 1);
+      j->io_burst = 1 + rand_r(&seed) % 10;
+      j->write = rand_r(&seed) % 2;
+      j->device = j->write;
+    }
+  }
+}
+
+//one tick of CPU's thread, which leaves the CPU before the callback so the
+//scheduler can dispatch the next one from it
+static void cpu_step(unsigned int cpu, unsigned int *exited)
+{
+  if(on_cpu[cpu] == NULL)
+  {
+    return;
+  }
+  if(switching > 0)
+  {
+    switching--;
+    counters.switch_ticks++;
+    return;
+  }
+  counters.busy++;
+  thread_t *t = on_cpu[cpu];
+  struct state *s = &threads[t->tid - 1];
+  s->ran++;
+  if(s->job->io_burst > 0 && s->ran == s->job->io_start)
+  {
+    on_cpu[cpu] = NULL;
+    s->io_queued = now;
+    asked[asked_count++] = t;
+    counters.callbacks++;
+    if(s->job->write)
+    {
+      sys_write(t);
+    }
+    else
+    {
+      sys_read(t);
+    }
+  }
+  else if(s->ran >= s->job->length)
+  {
+    on_cpu[cpu] = NULL;
+    (*exited)++;
+    counters.callbacks++;
+    sys_exit(t);
+  }
+}
+
+static void device_push(struct device *d, unsigned long key, thread_t *t)
+{
+  if(d->size == d->cap)
+  {
+    d->cap = d->cap ? d->cap * 2 : 64;
+    d->queue = realloc(d->queue, sizeof(struct waiter) * d->cap);
+  }
+  unsigned int i = d->size++;
+  while(i > 0 && d->queue[(i - 1) / 2].key > key)
+  {
+    d->queue[i] = d->queue[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  d->queue[i] = (struct waiter){ key, t };
+}
+
+static thread_t *device_pop(struct device *d)
+{
+  thread_t *top = d->queue[0].thread;
+  struct waiter last = d->queue[--d->size];
+  unsigned int i = 0;
+  for(;;)
+  {
+    unsigned int c = 2 * i + 1;
+    if(c >= d->size)
+    {
+      break;
+    }
+    if(c + 1 < d->size && d->queue[c + 1].key < d->queue[c].key)
+    {
+      c++;
+    }
+    if(d->queue[c].key >= last.key)
+    {
+      break;
+    }
+    d->queue[i] = d->queue[c];
+    i = c;
+  }
+  d->queue[i] = last;
+  return top;
+}
+
+//one tick of every device; the tick an I/O starts in is its first
+static void io_step(int cpu_busy)
+{
+  int io_busy = 0;
+  for(unsigned int i = 0; i < device_count; i++)
+  {
+    struct device *d = &devices[i];
+    device_t *stats = &counters.device[i];
+    if(d->on_device == NULL && d->size > 0)
+    {
+      d->on_device = device_pop(d);
+      struct state *s = &threads[d->on_device->tid - 1];
+      stats->ios++;
+      stats->queue_delay = stats->queue_delay + (now - s->io_queued - 1);
+      counters.callbacks++;
+      io_starting(d->on_device);
+    }
+    if(d->on_device != NULL)
+    {
+      io_busy = 1;
+      stats->busy++;
+      struct state *s = &threads[d->on_device->tid - 1];
+      if(++s->io_done >= s->job->io_burst)
+      {
+        thread_t *t = d->on_device;
+        d->on_device = NULL;
+        counters.callbacks++;
+        io_complete(t);
+      }
+    }
+  }
+  counters.overlap = counters.overlap + (cpu_busy && io_busy);
+
+  //this tick's requests can start from the next, in CPU order
+  for(unsigned int a = 0; a < asked_count; a++)
+  {
+    struct state *s = &threads[asked[a]->tid - 1];
+    unsigned int i = s->job->device % device_count;
+    unsigned long key = asked_seq++;
+    if(device_policy == IO_SHORTEST_BURST)
+    {
+      key = key | (unsigned long)s->job->io_burst << 40;
+    }
+    device_push(&devices[i], key, asked[a]);
+    if(devices[i].size > counters.device[i].max_queue)
+    {
+      counters.device[i].max_queue = devices[i].size;
+    }
+  }
+  asked_count = 0;
+}
+
+void engine_switch_cost(unsigned int ticks)
+{
+  switch_cost = ticks;
+}
+
+void engine_io(unsigned int count, enum io_policy policy)
+{
+  device_count = count < 1 ? 1 : count > MAX_DEVICES ? MAX_DEVICES : count;
+  device_policy = policy;
+}
+
+int engine_run(job_t *jobs, unsigned int count, int algorithm, unsigned int quantum, run_t *run)
+{
+  //the last run's threads are only let go now, its stats() pointed at them
+  free(threads);
+  threads = calloc(count ? count : 1, sizeof(struct state));
+  memset(&counters, 0, sizeof(counters));
+  counters.devices = device_count;
+  memset(on_cpu, 0, sizeof(on_cpu));
+  switching = 0;
+  held = 0;
+  asked_count = 0;
+  asked_seq = 0;
+  for(unsigned int i = 0; i < MAX_DEVICES; i++)
+  {
+    devices[i].on_device = NULL;
+    devices[i].size = 0;
+  }
+
+  //every thread fits end to end after the last arrival, twice over, even
+  //paying for a switch every tick
+  unsigned long limit = 16;
+  unsigned long last = 0;
+  for(unsigned int i = 0; i < count; i++)
+  {
+    threads[i].thread.tid = i + 1;
+    threads[i].thread.priority = jobs[i].priority;
+    threads[i].thread.length = jobs[i].length;
+    threads[i].job = &jobs[i];
+    limit = limit + 2 * (1 + switch_cost) * jobs[i].length + jobs[i].io_burst + 2;
+    if(jobs[i].arrival > last)
+    {
+      last = jobs[i].arrival;
+    }
+  }
+  limit = limit + last;
+
+  //arrival order, ties by tid
+  struct arrival *order = malloc(sizeof(struct arrival) * (count ? count : 1));
+  for(unsigned int i = 0; i < count; i++)
+  {
+    order[i].tick = jobs[i].arrival;
+    order[i].index = i;
+  }
+  qsort(order, count, sizeof(struct arrival), by_arrival);
+
+  set_cpu_dispatch(cpu_dispatch);
+  scheduler(algorithm, quantum);
+  cpus = cpu_count();
+  counters.cpus = cpus;
+  unsigned int arrived = 0;
+  unsigned int exited = 0;
+  for(now = 0; exited < count && (unsigned long)now <= limit; now++)
+  {
+    if(now > 0)
+    {
+      counters.callbacks++;
+      sim_tick();
+    }
+    while(arrived < count && order[arrived].tick == (unsigned int)now)
+    {
+      counters.callbacks++;
+      sys_exec(&threads[order[arrived++].index].thread);
+    }
+    if(held > 0)
+    {
+      held--;
+    }
+    else
+    {
+      counters.callbacks++;
+      sim_ready();
+    }
+    int cpu_busy = 0;
+    for(unsigned int cpu = 0; cpu < cpus; cpu++)
+    {
+      cpu_busy = cpu_busy || on_cpu[cpu] != NULL;
+      cpu_step(cpu, &exited);
+    }
+    io_step(cpu_busy);
+  }
+
+  counters.ticks = now;
+  *run = counters;
+  free(order);
+  return exited == count ? 0 : -1;
+}
+
+void engine_free()
+{
+  free(threads);
+  threads = NULL;
+  for(unsigned int i = 0; i < MAX_DEVICES; i++)
+  {
+    free(devices[i].queue);
+    devices[i] = (struct device){0};
+  }
+}
@@ -0,0 +1,110 @@
+/**
+ * Stand-in for the simulator, for driving the scheduler callbacks in-process
+ * without simulator.a. As many CPUs as the scheduler uses (see smp.h), CPU
+ * 0 driven by sim_dispatch() and the rest by set_cpu_dispatch(), and by
+ * default one FIFO I/O device (see engine_io()); each tick runs sim_tick(),
+ * sys_exec() for every arrival, sim_ready(), one tick of each CPU's thread
+ * in CPU order (ending in sys_read()/sys_write() or sys_exit()) and one
+ * tick of each I/O device in turn (io_starting() for the next in its
+ * queue, io_complete() when done).
+ *
+ * As in the simulator, a thread dispatched from sys_exec() or sim_ready()
+ * runs in the same tick and one dispatched from a later callback runs from
+ * the next; a context switch costs no tick of its own unless
+ * engine_switch_cost() says otherwise.
+ *
+ * Engine state is per OS thread and the scheduler's is in the thread's
+ * current context (see context.h), so every OS thread can run its own 
+ * simulations, one after another, independently of the rest.
+ */
+#ifndef __ENGINE_H
+#define __ENGINE_H
+
+#include "scheduler.h"
+
+/**
+ * One thread of a workload, as in the simulator's thread table. A thread
+ * with IO_BURST > 0 and 0 < IO_START < LENGTH does one I/O after IO_START
+ * ticks of CPU.
+ */
+typedef struct __job_t {
+  unsigned int arrival;
+  unsigned int priority;
+  unsigned int length;
+  unsigned int io_start;
+  unsigned int io_burst;
+  int write;                     // sys_write() rather than sys_read()
+  unsigned int device;           // Device DEVICE % engine_io() count does the I/O
+} job_t;
+
+#define MAX_DEVICES 16
+
+enum io_policy {
+  IO_FIFO,                       // In the order threads asked
+  IO_SHORTEST_BURST              // Shortest I/O burst first, ties in order
+};
+
+typedef struct __device_t {
+  unsigned long busy;            // Ticks spent doing I/O
+  unsigned long ios;             // I/Os started
+  unsigned long queue_delay;     // Ticks I/Os waited for the device, summed
+  unsigned int max_queue;        // Longest queue of I/Os waiting
+} device_t;
+
+typedef struct __run_t {
+  unsigned int ticks;            // Ticks simulated, up to the last sys_exit()
+  unsigned long callbacks;       // Calls into the scheduler
+  unsigned long dispatches;      // Dispatches onto any CPU
+  unsigned long switches;        // Dispatches replacing another thread on its CPU
+  unsigned long busy;            // Ticks a CPU ran a thread, summed over CPUs
+  unsigned long switch_ticks;    // Ticks a CPU spent switching, see engine_switch_cost()
+  unsigned int cpus;
+  unsigned long overlap;         // Ticks the CPU and at least one device were both busy
+  unsigned int devices;
+  device_t device[MAX_DEVICES];
+} run_t;
+
+/**
+ * Fill JOBS with COUNT random threads like the simulator's: priority 0-4,
+ * CPU burst 1-20 and a third doing one I/O of 1-10 ticks part way through.
+ * Reads are on device 0 and writes device 1, so two devices make separate
+ * read and write channels.
+ * Thread i arrives at i * SPACING plus up to 9 ticks, so a SPACING near the
+ * mean burst of 10 keeps the CPU busy without the ready queue growing
+ * without bound.
+ */
+void jobs_random(job_t *jobs, unsigned int count, unsigned int seed, unsigned int spacing);
+
+/**
+ * Give this OS thread's next runs COUNT I/O devices, 1 to MAX_DEVICES, each
+ * with its own queue in POLICY order. An I/O is queued from the tick after
+ * the thread asks and the tick it starts in is its first.
+ */
+void engine_io(unsigned int count, enum io_policy policy);
+
+/**
+ * Charge TICKS for every switch on this OS thread's next runs with one CPU:
+ * the CPU runs nothing for TICKS ticks after a dispatch replaces one thread
+ * with another, and sim_ready() is held back for as many ticks from the one
+ * after, so the switch uses up none of the new thread's quantum. Arrivals
+ * and I/O carry on meanwhile. 0 (the default) makes switches free, as in
+ * the simulator. The scheduler is not told, so its CPU time for the new
+ * thread includes the switch.
+ */
+void engine_switch_cost(unsigned int ticks);
+
+/**
+ * Run scheduler(ALGORITHM, QUANTUM) over COUNT JOBS, thread i getting tid
+ * i + 1, until every thread has exited. Fills in RUN and returns 0, or -1 if
+ * threads were still running after a generous tick limit. The scheduler's
+ * stats() are left for the caller to collect, and the threads they refer
+ * to stay valid until the next engine_run() on this OS thread.
+ */
+int engine_run(job_t *jobs, unsigned int count, int algorithm, unsigned int quantum, run_t *run);
+
+/**
+ * Free the calling OS thread's engine state, threads of the last run included.
+ */
+void engine_free();
+
+#endif // __ENGINE_H
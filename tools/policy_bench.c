@@ -0,0 +1,56 @@
+/**
+ * Times one large simulation on the stand-in engine, for comparing a build
+ * specialized with -DSPECIALIZE=<algorithm> against the runtime-selected
+ * one. A specialized build ignores ALGORITHM. See make bench-specialize.
+ *
+ *   policy-bench ALGORITHM [THREADS] [SEED]
+ *
+ * ns/callback is wall time over every call into the scheduler, so it
+ * includes the engine's own per-tick work; both builds share that.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "engine.h"
+#include "algorithms.h"
+
+int main(int argc, char *argv[])
+{
+  //it would stand in for every algorithm asked for below
+  if(getenv("SCHED_ALGORITHM") != NULL)
+  {
+    fprintf(stderr, "%s: SCHED_ALGORITHM is set, unset it to run\n", argv[0]);
+    return 1;
+  }
+
+  if(argc < 2 || algorithm_by_name(argv[1]) < 0)
+  {
+    fprintf(stderr, "usage: %s ALGORITHM [THREADS] [SEED]\n", argv[0]);
+    return 1;
+  }
+  unsigned int count = argc > 2 ? atoi(argv[2]) : 200000;
+  unsigned int seed = argc > 3 ? atoi(argv[3]) : 1;
+#ifdef SPECIALIZE
+  const char *name = algorithm_name(SPECIALIZE);
+  const char *build = "specialized";
+#else
+  const char *name = argv[1];
+  const char *build = "runtime";
+#endif
+
+  job_t *jobs = malloc(sizeof(job_t) * count);
+  jobs_random(jobs, count, seed, 14);
+
+  run_t run;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int rc = engine_run(jobs, count, algorithm_by_name(name), 4, &run);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+  stats_t *s = stats();
+  printf("%-12s %-12s %8u threads %10lu callbacks %7.2f ns/callback  wait %u%s\n",
+         name, build, count, run.callbacks, ns / run.callbacks, s->waiting_time,
+         rc ? "  DID NOT FINISH" : "");
+  return rc ? 1 : 0;
+}
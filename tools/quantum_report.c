@@ -0,0 +1,135 @@
+/**
+ * Adaptive quantum report: round robin with fixed quanta against the
+ * adaptive ones of set_quantum_mode(), on the stand-in engine, over the
+ * simulator's uniform workload (see jobs_random()) and a synthetic one (see
+ * workload.h).
+ *
+ *   quantum-report [-n THREADS] [-s SEEDS] [-q QUANTUM] [-c COST]
+ *
+ * Each row is SEEDS simulations (default 20) of THREADS threads (default
+ * 200) in a context of its own: fixed quanta 1, 2, 4, 8 and 16, then the
+ * global and per thread modes starting from QUANTUM (default 4). The engine
+ * charges COST ticks per switch (default 1, see engine_switch_cost()), so
+ * short quanta pay for their switches in waiting and turnaround; with -c 0
+ * switches are free, as in the simulator. The scheduler is told the same
+ * cost (see set_switch_cost()) and keeps a thread due to finish within it
+ * on the CPU past its quantum. Columns are means per simulation: the
+ * quantum handed out, CPU bursts measured, switches made, ticks the CPU
+ * spent on them, rotations deferred (once per dispatch however long the
+ * thread is kept, see switch_stats()), and the threads' mean waiting and
+ * turnaround. Exits 1 if any simulation does not finish.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "engine.h"
+#include "workload.h"
+#include "algorithms.h"
+#include "context.h"
+#include "monitor.h"
+
+#define FIXED_QUANTA 5
+
+const char *mode_names[] = { "fixed", "global", "thread" };
+
+int failed = 0;
+
+void row(const char *label, enum quantum_mode mode, unsigned int quantum, unsigned int cost, unsigned int count,
+         unsigned int seeds, int synthetic)
+{
+  double mean_quantum = 0, bursts = 0, switches = 0, lost = 0, deferred = 0, waiting = 0, turnaround = 0;
+  job_t *jobs = malloc(sizeof(job_t) * count);
+  workload_t w;
+  workload_default(&w);
+
+  //a fresh context, so nothing is left over from the rows before
+  context_t *c = context_create();
+  context_use(c);
+  set_quantum_mode(mode);
+  set_switch_cost(cost);
+  for(unsigned int seed = 1; seed <= seeds; seed++)
+  {
+    if(synthetic)
+    {
+      workload_generate(&w, jobs, count, seed);
+    }
+    else
+    {
+      jobs_random(jobs, count, seed, 0);
+    }
+
+    run_t run;
+    failed = engine_run(jobs, count, ROUND_ROBIN, quantum, &run) != 0 || failed;
+    quantum_stats_t q;
+    quantum_stats(&q);
+    switch_stats_t sw;
+    switch_stats(&sw);
+    stats_t *s = stats();
+    mean_quantum = mean_quantum + q.mean_quantum;
+    bursts = bursts + q.bursts;
+    switches = switches + run.switches;
+    lost = lost + run.switch_ticks;
+    deferred = deferred + sw.deferred;
+    waiting = waiting + s->waiting_time;
+    turnaround = turnaround + s->turnaround_time;
+    free(s->tstats);
+    free(s);
+  }
+  context_destroy(c);
+  free(jobs);
+
+  printf("%-10s %-7s %7u %8.2f %9.1f %9.1f %9.1f %9.1f %9.2f %10.2f\n", label, mode_names[mode], quantum,
+         mean_quantum / seeds, bursts / seeds, switches / seeds, lost / seeds, deferred / seeds, waiting / seeds,
+         turnaround / seeds);
+}
+
+int main(int argc, char *argv[])
+{
+  //it would stand in for every algorithm asked for below
+  if(getenv("SCHED_ALGORITHM") != NULL)
+  {
+    fprintf(stderr, "%s: SCHED_ALGORITHM is set, unset it to run\n", argv[0]);
+    return 2;
+  }
+
+  unsigned int count = 200;
+  unsigned int seeds = 20;
+  unsigned int quantum = 4;
+  unsigned int cost = 1;
+  unsigned int fixed[FIXED_QUANTA] = { 1, 2, 4, 8, 16 };
+
+  int opt;
+  while((opt = getopt(argc, argv, "n:s:q:c:")) != -1)
+  {
+    int bad = 0;
+    switch(opt)
+    {
+      case 'n': count = atoi(optarg); break;
+      case 's': seeds = atoi(optarg); break;
+      case 'q': quantum = atoi(optarg); break;
+      case 'c': cost = atoi(optarg); break;
+      default: bad = 1;
+    }
+    if(bad || count < 1 || seeds < 1 || quantum < 1)
+    {
+      fprintf(stderr, "usage: %s [-n THREADS] [-s SEEDS] [-q QUANTUM] [-c COST]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  engine_switch_cost(cost);
+  printf("%-10s %-7s %7s %8s %9s %9s %9s %9s %9s %10s\n", "workload", "mode", "quantum", "mean q", "bursts",
+         "switches", "lost", "deferred", "waiting", "turnaround");
+  for(int synthetic = 0; synthetic <= 1; synthetic++)
+  {
+    const char *label = synthetic ? "synthetic" : "uniform";
+    for(unsigned int i = 0; i < FIXED_QUANTA; i++)
+    {
+      row(label, QUANTUM_FIXED, fixed[i], cost, count, seeds, synthetic);
+    }
+    row(label, QUANTUM_GLOBAL, quantum, cost, count, seeds, synthetic);
+    row(label, QUANTUM_PER_THREAD, quantum, cost, count, seeds, synthetic);
+  }
+  engine_free();
+  return failed;
+}
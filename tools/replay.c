@@ -0,0 +1,215 @@
+/**
+ * Replays a callback trace (see trace.h) against the scheduler, straight from
+ * the memory-mapped file and without the simulator, and reports the
+ * scheduler's stats and cost per callback.
+ *
+ *   replay TRACE [-a ALGORITHM] [-q QUANTUM] [-n REPEAT]
+ *   replay TRACE -p
+ *
+ * The recorded algorithm and quantum are used unless overridden. With them,
+ * every sim_dispatch() the scheduler makes should match the recorded one
+ * and mismatches are counted; with another policy the recorded callbacks
+ * no longer follow from its decisions, but they still make a realistic
+ * benchmark input. REPEAT replays the trace that many times in one context
+ * and reports the fastest. Exits 1 if any dispatch mismatched.
+ *
+ * With -p the records are printed instead, one per line as time, kind, tid
+ * and ready queue length, to set beside the simulator's Gantt chart.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "scheduler.h"
+#include "algorithms.h"
+#include "trace.h"
+
+const char *kind_names[] = {
+  [TRACE_EXEC] = "exec",
+  [TRACE_READY] = "ready",
+  [TRACE_READ] = "read",
+  [TRACE_WRITE] = "write",
+  [TRACE_EXIT] = "exit",
+  [TRACE_IO_COMPLETE] = "io_complete",
+  [TRACE_IO_STARTING] = "io_starting",
+  [TRACE_DISPATCH] = "dispatch",
+};
+
+//dispatches made by the callback being replayed
+#define MAX_ISSUED 64
+
+int now = 0;
+unsigned int issued[MAX_ISSUED];
+unsigned int issued_count = 0;
+
+int sim_time()
+{
+  return now;
+}
+
+void sim_dispatch(thread_t *t)
+{
+  if(issued_count < MAX_ISSUED)
+  {
+    issued[issued_count] = t ? t->tid : 0;
+  }
+  issued_count++;
+}
+
+//drive one callback per record; returns the number of dispatches that
+//differ from the recorded ones
+unsigned long replay(const trace_map_t *map, thread_t *threads)
+{
+  unsigned long mismatches = 0;
+  unsigned int checked = 0;
+  int time = -1;
+  for(unsigned long i = 0; i < map->count; i++)
+  {
+    const trace_record_t *rec = &map->records[i];
+    if(rec->kind == TRACE_DISPATCH)
+    {
+      if(checked >= issued_count || (checked < MAX_ISSUED && issued[checked] != rec->tid))
+      {
+        mismatches++;
+      }
+      checked++;
+      continue;
+    }
+
+    //dispatches the scheduler made that the recording did not
+    if(issued_count > checked)
+    {
+      mismatches = mismatches + issued_count - checked;
+    }
+    issued_count = 0;
+    checked = 0;
+
+    if((int)rec->time != time)
+    {
+      time = rec->time;
+      now = time;
+      if(now > 0)
+      {
+        sim_tick();
+      }
+    }
+
+    thread_t *t = &threads[rec->tid];
+    switch(rec->kind)
+    {
+      case TRACE_EXEC:
+        t->tid = rec->tid;
+        t->priority = rec->priority;
+        t->length = rec->length;
+        sys_exec(t);
+        break;
+      case TRACE_READY: sim_ready(); break;
+      case TRACE_READ: sys_read(t); break;
+      case TRACE_WRITE: sys_write(t); break;
+      case TRACE_EXIT: sys_exit(t); break;
+      case TRACE_IO_COMPLETE: io_complete(t); break;
+      case TRACE_IO_STARTING: io_starting(t); break;
+    }
+  }
+  if(issued_count > checked)
+  {
+    mismatches = mismatches + issued_count - checked;
+  }
+  issued_count = 0;
+  return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+  //it would stand in for every algorithm asked for below
+  if(getenv("SCHED_ALGORITHM") != NULL)
+  {
+    fprintf(stderr, "%s: SCHED_ALGORITHM is set, unset it to run\n", argv[0]);
+    return 2;
+  }
+
+  int algorithm = -1;
+  int quantum = -1;
+  int repeat = 1;
+  int print = 0;
+  int opt;
+  while((opt = getopt(argc, argv, "a:q:n:p")) != -1)
+  {
+    switch(opt)
+    {
+      case 'a': algorithm = algorithm_by_name(optarg); repeat = algorithm < 0 ? 0 : repeat; break;
+      case 'q': quantum = atoi(optarg); break;
+      case 'n': repeat = atoi(optarg); break;
+      case 'p': print = 1; break;
+      default: repeat = 0;
+    }
+  }
+  if(optind != argc - 1 || repeat < 1)
+  {
+    fprintf(stderr, "usage: %s TRACE [-a ALGORITHM] [-q QUANTUM] [-n REPEAT] | TRACE -p\n", argv[0]);
+    return 2;
+  }
+
+  trace_map_t map;
+  if(trace_map(argv[optind], &map) != 0)
+  {
+    fprintf(stderr, "replay: %s is not a readable trace\n", argv[optind]);
+    return 1;
+  }
+  if(print)
+  {
+    for(unsigned long i = 0; i < map.count; i++)
+    {
+      const trace_record_t *rec = &map.records[i];
+      printf("%6u %-11s %6u %6u\n", rec->time, rec->kind < TRACE_KINDS ? kind_names[rec->kind] : "?",
+             rec->tid, rec->ready);
+    }
+    trace_unmap(&map);
+    return 0;
+  }
+
+  algorithm = algorithm >= 0 ? algorithm : (int)map.header->algorithm;
+  quantum = quantum >= 0 ? quantum : (int)map.header->quantum;
+
+  unsigned int max_tid = 0;
+  unsigned long callbacks = 0;
+  for(unsigned long i = 0; i < map.count; i++)
+  {
+    if(map.records[i].tid > max_tid)
+    {
+      max_tid = map.records[i].tid;
+    }
+    callbacks = callbacks + (map.records[i].kind != TRACE_DISPATCH);
+  }
+  thread_t *threads = calloc(max_tid + 1, sizeof(thread_t));
+
+  double best = 0;
+  unsigned long mismatches = 0;
+  stats_t *s = NULL;
+  for(int r = 0; r < repeat; r++)
+  {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    scheduler(algorithm, quantum);
+    mismatches = replay(&map, threads);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    best = r == 0 || ns < best ? ns : best;
+
+    if(s != NULL)
+    {
+      free(s->tstats);
+      free(s);
+    }
+    s = stats();
+  }
+
+  printf("%s: %lu records, recorded with %s quantum %d\n", argv[optind], map.count,
+         algorithm_name(map.header->algorithm), (int)map.header->quantum);
+  printf("replayed with %s quantum %d: %lu callbacks, %lu dispatch mismatches, %.2f ns/callback\n",
+         algorithm_name(algorithm), quantum, callbacks, mismatches, callbacks ? best / callbacks : 0);
+  printf("%u threads, mean turnaround %u, mean waiting %u\n", s->thread_count, s->turnaround_time, s->waiting_time);
+
+  trace_unmap(&map);
+  return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * Scaling benchmark: one simulation per algorithm and thread count on the
+ * stand-in engine, over a synthetic workload (see workload.h), reporting
+ * callbacks per second and memory as the thread count grows tenfold from
+ * 1000 up to MAX_THREADS.
+ *
+ *   scale [-a ALGORITHMS] [-n MAX_THREADS] [-q QUANTUM] [-s SEED]
+ *         [-l LOAD] [-t TAIL] [-g GROUP] [-i IO_FRACTION] [-p SKEW]
+ *         [-D DEVICES] [-B] [-c CPUS]
+ *
+ * ALGORITHMS is a comma separated list defaulting to the simulator's eight;
+ * MAX_THREADS defaults to 1000000. TAIL is the Pareto alpha of CPU bursts
+ * (0 for exponential), GROUP the mean arrivals per group and SKEW the Zipf
+ * exponent of priorities; the rest of the workload is workload_default().
+ * I/O is spread over DEVICES devices (default 1), each queueing FIFO or,
+ * with -B, shortest burst first; io util is their mean utilization and io
+ * delay the mean ticks an I/O queued for its device. Simulations run on
+ * CPUS simulated CPUs (default 1, see smp.h); cpu util is their mean
+ * utilization and steals the threads taken from another CPU's queue.
+ *
+ * Each run is in a child process of its own, so its memory is the child's
+ * peak resident size less what it started with: the workload, the engine's
+ * threads and the scheduler's queues and table at their largest.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "engine.h"
+#include "workload.h"
+#include "algorithms.h"
+#include "smp.h"
+
+#define MAX_LIST 64
+
+double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//resident set in bytes
+long resident()
+{
+  long pages = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if(f != NULL)
+  {
+    if(fscanf(f, "%*s %ld", &pages) != 1)
+    {
+      pages = 0;
+    }
+    fclose(f);
+  }
+  return pages * sysconf(_SC_PAGESIZE);
+}
+
+int main(int argc, char *argv[])
+{
+  //it would stand in for every algorithm asked for below
+  if(getenv("SCHED_ALGORITHM") != NULL)
+  {
+    fprintf(stderr, "%s: SCHED_ALGORITHM is set, unset it to run\n", argv[0]);
+    return 2;
+  }
+
+  unsigned int algorithms[MAX_LIST] = { FIRST_COME_FIRST_SERVED, ROUND_ROBIN, NON_PREEMPTIVE_PRIORITY,
+                                        PREEMPTIVE_PRIORITY, NON_PREEMPTIVE_SHORTEST_JOB_FIRST,
+                                        PREEMPTIVE_SHORTEST_JOB_FIRST, NON_PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST,
+                                        PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST };
+  unsigned int algorithm_count = 8;
+  unsigned int max_threads = 1000000;
+  unsigned int quantum = 4;
+  unsigned long seed = 1;
+  unsigned int devices = 1;
+  unsigned int cpus = 1;
+  enum io_policy io_policy = IO_FIFO;
+  workload_t w;
+  workload_default(&w);
+
+  int opt;
+  while((opt = getopt(argc, argv, "a:n:q:s:l:t:g:i:p:D:Bc:")) != -1)
+  {
+    int bad = 0;
+    switch(opt)
+    {
+      case 'a':
+        algorithm_count = 0;
+        for(char *tok = strtok(optarg, ","); tok != NULL && !bad; tok = strtok(NULL, ","))
+        {
+          int a = algorithm_by_name(tok);
+          bad = a < 0 || algorithm_count == MAX_LIST;
+          if(!bad)
+          {
+            algorithms[algorithm_count++] = a;
+          }
+        }
+        bad = bad || algorithm_count == 0;
+        break;
+      case 'n': max_threads = atoi(optarg); break;
+      case 'q': quantum = atoi(optarg); break;
+      case 's': seed = strtoul(optarg, NULL, 10); break;
+      case 'l': w.load = atof(optarg); break;
+      case 't': w.burst_alpha = atof(optarg); break;
+      case 'g': w.group = atof(optarg); break;
+      case 'i': w.io_fraction = atof(optarg); break;
+      case 'p': w.priority_skew = atof(optarg); break;
+      case 'D': devices = atoi(optarg); break;
+      case 'B': io_policy = IO_SHORTEST_BURST; break;
+      case 'c': cpus = atoi(optarg); break;
+      default: bad = 1;
+    }
+    if(bad || max_threads < 1000 || quantum < 1 || w.load <= 0 || (w.burst_alpha != 0 && w.burst_alpha <= 1)
+       || devices < 1 || devices > MAX_DEVICES || cpus < 1 || cpus > MAX_CPUS)
+    {
+      fprintf(stderr, "usage: %s [-a ALGORITHMS] [-n MAX_THREADS] [-q QUANTUM] [-s SEED]\n"
+                      "       [-l LOAD] [-t TAIL] [-g GROUP] [-i IO_FRACTION] [-p SKEW] [-D DEVICES] [-B] [-c CPUS]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  engine_io(devices, io_policy);
+  set_cpus(cpus);
+  printf("%-12s %8s %11s %9s %12s %9s %10s %9s %8s %8s %8s %7s\n", "algorithm", "threads", "callbacks", "ms",
+         "callbacks/s", "rss MB", "bytes/thr", "waiting", "io util", "io delay", "cpu util", "steals");
+  int failed = 0;
+  for(unsigned int a = 0; a < algorithm_count; a++)
+  {
+    for(unsigned long n = 1000; n <= max_threads; n = n * 10)
+    {
+      fflush(stdout);
+      pid_t child = fork();
+      if(child == 0)
+      {
+        long before = resident();
+        job_t *jobs = malloc(sizeof(job_t) * n);
+        workload_generate(&w, jobs, n, seed);
+        run_t run;
+        double start = seconds();
+        int rc = engine_run(jobs, n, algorithms[a], quantum, &run);
+        double elapsed = seconds() - start;
+        stats_t *s = stats();
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        long peak = usage.ru_maxrss * 1024 - before;
+        double busy = 0, delay = 0, ios = 0;
+        for(unsigned int d = 0; d < run.devices; d++)
+        {
+          busy = busy + run.device[d].busy;
+          delay = delay + run.device[d].queue_delay;
+          ios = ios + run.device[d].ios;
+        }
+        double utilization = 0;
+        unsigned long steals = 0;
+        for(unsigned int c = 0; c < cpu_count(); c++)
+        {
+          cpu_stats_t cs;
+          cpu_stats(c, &cs);
+          utilization = utilization + cs.utilization / cpu_count();
+          steals = steals + cs.steals;
+        }
+        printf("%-12s %8lu %11lu %9.1f %12.0f %9.1f %10.0f %9u %7.1f%% %8.2f %7.1f%% %7lu%s\n",
+               algorithm_name(algorithms[a]), n, run.callbacks, elapsed * 1e3, run.callbacks / elapsed,
+               peak / 1048576.0, (double)peak / n, s->waiting_time, 100 * busy / run.ticks / run.devices,
+               ios ? delay / ios : 0, 100 * utilization, steals, rc ? "  DID NOT FINISH" : "");
+        exit(rc ? 1 : 0);
+      }
+      int status = 1;
+      waitpid(child, &status, 0);
+      failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+  }
+  return failed ? 1 : 0;
+}
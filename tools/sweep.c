@@ -0,0 +1,612 @@
+/**
+ * In-process regression sweep: every combination of algorithm, thread count,
+ * quantum and seed is one simulation on the stand-in engine, run by a pool
+ * of worker threads that each reuse one scheduler context for all of their
+ * simulations.
+ *
+ *   sweep [-a ALGORITHMS] [-t THREADS] [-q QUANTA] [-s SEEDS] [-j WORKERS] [-c CPUS]
+ *         [-g FILE | -G FILE]
+ *
+ * ALGORITHMS, THREADS and QUANTA are comma separated lists, defaulting to
+ * every algorithm, 2..8 and 200 threads, so p99 and max part, and quanta
+ * 1..4. Only RR and MLFQ read the quantum, so the others run with the first
+ * of QUANTA alone. Seeds run 1..SEEDS (default 20). WORKERS defaults to the
+ * number of online CPUs. Simulations run on CPUS simulated CPUs (see smp.h),
+ * by default SCHED_CPUS or 1; util is their mean utilization. P99 and max
+ * are the tail of the threads' waiting times (see waiting_percentile()),
+ * fair their mean absolute fairness deviation (see thread_stats()). Misses
+ * and lateness are the real-time policies' deadline misses and mean lateness
+ * (see rt_stats()), 0 for the others. Switches are the engine's, late the
+ * dispatches whose thread starts the tick after and deferred those whose
+ * thread kept the CPU past a switch under SCHED_SWITCH_COST (see
+ * switch_stats()), no more than one each. MLFQ rows are followed by the mean
+ * ticks run and entries made at each level (see mlfq_stats()).
+ *
+ * A run passes when every thread exits and each thread's stats are
+ * consistent with its workload: turnaround at least its CPU and I/O bursts,
+ * waiting no more than the rest of its turnaround and CPU time equal to its
+ * CPU bursts. Across the threads, no more than 1% may wait longer than p99,
+ * and the longest wait must match snapshot(). Under EDF and RM every thread
+ * must have a deadline and be either admitted or rejected, with rt_stats()
+ * agreeing with the threads on misses and lateness; under the others none
+ * may have one. The scheduler's I/O queueing delay (see io_stats()) must
+ * match the engine's and its CPUs' busy time (see cpu_stats()) add up to the
+ * threads' CPU bursts. Under MLFQ the level ticks must add up to the CPU
+ * bursts too, and the top level must have seen every thread.
+ *
+ * Those checks only show the scheduler agrees with itself. -G records each
+ * run's turnaround and waiting sums and a checksum of its threads' stats in
+ * FILE as a regression snapshot, and -g fails every run that FILE disagrees
+ * with or has no line for. tools/sweep.golden is the snapshot for the
+ * defaults on one CPU, with no SCHED_* settings in the environment; `make
+ * sweep` checks against it. It was taken from this scheduler on the stand-in
+ * engine, so it catches changes of schedule but not wrong ones, and passing
+ * it is no PASS from simulator.a. For that `make sweep` also replays
+ * tools/traces, recorded from runs simulator.a passed (see tools/replay.c).
+ * Record it again only for an intended change of schedule.
+ *
+ * Last come checks of what the policies are for, each on workloads of its
+ * own on one CPU. CFS must leave 8 threads a smaller mean fairness deviation
+ * than p-priority does over seeds 1..SEEDS. Under both priority policies
+ * aging must cut the wait of a priority 4 thread stuck behind a stream of
+ * priority 0 ones. On 20 workloads of 50 threads without I/O, EDF must miss
+ * no deadline in those it admits whole, and RM's utilization bound must
+ * reject more threads than EDF's. Exits 1 if any run or check fails.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "engine.h"
+#include "algorithms.h"
+#include "context.h"
+#include "monitor.h"
+#include "smp.h"
+
+#define MAX_LIST 64
+#define MAX_LEVELS 8
+
+//the starvation check's stream of high priority threads, see starved_wait()
+#define STREAM 60
+#define STREAM_AGING 4
+
+//the deadline checks' workloads, see deadlines(); a few of these seeds are
+//admitted whole
+#define RT_THREADS 50
+#define RT_SPACING 10
+#define RT_SEEDS 20
+
+typedef struct list {
+    unsigned int item[MAX_LIST];
+    unsigned int size;
+}list;
+
+//one simulation and its outcome
+typedef struct run {
+    unsigned int algorithm;
+    unsigned int threads;
+    unsigned int quantum;
+    unsigned int seed;
+    int pass;
+    unsigned int turnaround;
+    unsigned int waiting;
+    unsigned int p99;
+    unsigned int max_waiting;
+    unsigned long switches;
+    unsigned int late_starts;
+    unsigned int deferred;
+    double utilization;
+    double fairness;
+    unsigned int misses;
+    double lateness;
+    unsigned int level_ticks[MAX_LEVELS];
+    unsigned int level_entries[MAX_LEVELS];
+    unsigned long turnaround_sum;
+    unsigned long waiting_sum;
+    unsigned int checksum;
+}run;
+
+struct run *runs = NULL;
+unsigned int run_count = 0;
+unsigned int next_run = 0;
+unsigned int cpus = 0;
+unsigned int checks_failed = 0;
+
+int parse(const char *arg, struct list *l, int names)
+{
+  char *copy = strdup(arg);
+  l->size = 0;
+  for(char *tok = strtok(copy, ","); tok != NULL; tok = strtok(NULL, ","))
+  {
+    int v = names ? algorithm_by_name(tok) : atoi(tok);
+    if(v < 0 || (!names && v == 0) || l->size == MAX_LIST)
+    {
+      fprintf(stderr, "sweep: bad list entry '%s'\n", tok);
+      free(copy);
+      return -1;
+    }
+    l->item[l->size++] = v;
+  }
+  free(copy);
+  return l->size ? 0 : -1;
+}
+
+void simulate(struct run *r)
+{
+  job_t *jobs = malloc(sizeof(job_t) * r->threads);
+  jobs_random(jobs, r->threads, r->seed, 0);
+
+  run_t result;
+  r->pass = engine_run(jobs, r->threads, r->algorithm, r->quantum, &result) == 0;
+  r->switches = result.switches;
+  switch_stats_t sw;
+  switch_stats(&sw);
+  r->late_starts = sw.late_starts;
+  r->deferred = sw.deferred;
+  //a thread kept on the CPU past a switch counts once, however long it keeps it
+  r->pass = r->pass && sw.deferred <= sw.dispatches;
+  io_stats_t io;
+  io_stats(&io);
+  unsigned long delay = 0;
+  for(unsigned int d = 0; d < result.devices; d++)
+  {
+    delay = delay + result.device[d].queue_delay;
+  }
+  r->pass = r->pass && io.delay_sum == delay;
+
+  unsigned long length = 0, busy = 0;
+  for(unsigned int i = 0; i < r->threads; i++)
+  {
+    length = length + jobs[i].length;
+  }
+  r->utilization = 0;
+  for(unsigned int c = 0; c < cpu_count(); c++)
+  {
+    cpu_stats_t cs;
+    cpu_stats(c, &cs);
+    busy = busy + cs.busy_time;
+    r->utilization = r->utilization + cs.utilization / cpu_count();
+  }
+  r->pass = r->pass && busy == length;
+
+  //every thread enters the top level and all of its CPU time is spent at one level or another
+  if(r->algorithm == MULTILEVEL_FEEDBACK_QUEUE)
+  {
+    unsigned long ticks = 0;
+    for(unsigned int l = 0; l < mlfq_levels() && l < MAX_LEVELS; l++)
+    {
+      level_stats_t ls;
+      mlfq_stats(l, &ls);
+      r->level_ticks[l] = ls.ticks;
+      r->level_entries[l] = ls.entries;
+      ticks = ticks + ls.ticks;
+    }
+    r->pass = r->pass && ticks == length && r->level_entries[0] >= r->threads;
+  }
+
+  stats_t *s = stats();
+  double spread = 0;
+  snapshot_t snap;
+  snapshot(&snap);
+  r->p99 = waiting_percentile(99);
+  r->max_waiting = waiting_percentile(100);
+  unsigned int tail = 0;
+  unsigned int deadlines = 0, late = 0;
+  int latest = 0;
+  long lateness = 0;
+  r->turnaround_sum = snap.turnaround_sum;
+  r->waiting_sum = snap.waiting_sum;
+  r->checksum = 0;
+  r->pass = r->pass && s->thread_count == r->threads;
+  for(unsigned int i = 0; r->pass && i < s->thread_count; i++)
+  {
+    stats_t *ts = &s->tstats[i];
+    r->checksum = (r->checksum * 31 + ts->tid) * 31 + ts->waiting_time;
+    r->checksum = r->checksum * 31 + ts->turnaround_time;
+    job_t *j = &jobs[ts->tid - 1];
+    unsigned int busy = j->length + j->io_burst;
+    thread_stats_t th = { 0 };
+    r->pass = ts->turnaround_time >= busy && ts->waiting_time <= ts->turnaround_time - busy &&
+              thread_stats(ts->tid, &th) == 0 && th.cpu_time == j->length;
+    spread = spread + (th.fairness < 0 ? -th.fairness : th.fairness);
+    tail = tail + (ts->waiting_time > r->p99);
+    if(th.deadline)
+    {
+      latest = deadlines == 0 || th.lateness > latest ? th.lateness : latest;
+      deadlines++;
+      late = late + (th.lateness > 0);
+      lateness = lateness + th.lateness;
+    }
+  }
+  //no more than 1% of the threads wait longer than p99
+  r->pass = r->pass && r->p99 <= r->max_waiting && tail * 100 <= s->thread_count;
+
+  //the real-time policies give every thread a deadline and count a miss for each one completed late
+  rt_stats_t rt;
+  rt_stats(&rt);
+  int real_time = r->algorithm == EARLIEST_DEADLINE_FIRST || r->algorithm == RATE_MONOTONIC;
+  r->misses = rt.misses;
+  r->lateness = rt.mean_lateness;
+  r->pass = r->pass && deadlines == (real_time ? s->thread_count : 0) &&
+            rt.admitted + rt.rejected == deadlines && rt.misses == late && rt.misses <= deadlines &&
+            rt.max_lateness == latest;
+  double mean = s->thread_count ? (double)lateness / s->thread_count : 0;
+  r->pass = r->pass && (rt.mean_lateness < mean ? mean - rt.mean_lateness : rt.mean_lateness - mean) <= 1e-9;
+  r->fairness = s->thread_count ? spread / s->thread_count : 0;
+  r->turnaround = s->turnaround_time;
+  r->waiting = s->waiting_time;
+
+  free(s->tstats);
+  free(s);
+  free(jobs);
+}
+
+//of the policies only round robin and MLFQ size their slices by the quantum
+int quantum_sensitive(unsigned int algorithm)
+{
+  return algorithm == ROUND_ROBIN || algorithm == MULTILEVEL_FEEDBACK_QUEUE;
+}
+
+//one line per run, in run order
+int write_golden(const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if(file == NULL)
+  {
+    perror(path);
+    return -1;
+  }
+  fprintf(file, "# algorithm threads quantum seed turnaround waiting checksum\n");
+  for(unsigned int i = 0; i < run_count; i++)
+  {
+    struct run *r = &runs[i];
+    fprintf(file, "%s %u %u %u %lu %lu %u\n", algorithm_name(r->algorithm), r->threads, r->quantum, r->seed,
+            r->turnaround_sum, r->waiting_sum, r->checksum);
+  }
+  return fclose(file);
+}
+
+//fail every run the snapshot in PATH disagrees with or does not cover, return how many
+int check_golden(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if(file == NULL)
+  {
+    perror(path);
+    return -1;
+  }
+
+  char *checked = calloc(run_count, 1);
+  char line[128];
+  char name[32];
+  unsigned int next = 0;
+  int differ = 0;
+  while(fgets(line, sizeof(line), file) != NULL)
+  {
+    struct run ref;
+    if(line[0] == '#' || sscanf(line, "%31s %u %u %u %lu %lu %u", name, &ref.threads, &ref.quantum, &ref.seed,
+                                &ref.turnaround_sum, &ref.waiting_sum, &ref.checksum) != 7)
+    {
+      continue;
+    }
+
+    //the file is written in run order, so the match is usually the run after the last one
+    int algorithm = algorithm_by_name(name);
+    for(unsigned int n = 0; n < run_count; n++)
+    {
+      unsigned int i = (next + n) % run_count;
+      struct run *r = &runs[i];
+      if((int)r->algorithm == algorithm && r->threads == ref.threads && r->quantum == ref.quantum &&
+         r->seed == ref.seed)
+      {
+        int same = r->turnaround_sum == ref.turnaround_sum && r->waiting_sum == ref.waiting_sum &&
+                   r->checksum == ref.checksum;
+        differ = differ + !same;
+        r->pass = r->pass && same;
+        checked[i] = 1;
+        next = i + 1;
+        break;
+      }
+    }
+  }
+  fclose(file);
+
+  for(unsigned int i = 0; i < run_count; i++)
+  {
+    differ = differ + !checked[i];
+    runs[i].pass = runs[i].pass && checked[i];
+  }
+  free(checked);
+  return differ;
+}
+
+/*= = = = = = = = = = = = = = = = = BEHAVIOUR CHECKS = = = = = = = = = = = = = = = = =*/
+
+//print one check of what a policy does and count it if it fails
+void expect(int pass, const char *format, ...)
+{
+  char what[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(what, sizeof(what), format, args);
+  va_end(args);
+  printf("%-80s %s\n", what, pass ? "ok" : "FAILED");
+  checks_failed = checks_failed + !pass;
+}
+
+//threads' mean absolute fairness deviation under ALGORITHM over SEEDS random workloads
+double mean_fairness(int algorithm, unsigned int threads, unsigned int seeds)
+{
+  job_t *jobs = malloc(sizeof(job_t) * threads);
+  double spread = 0;
+  for(unsigned int seed = 1; seed <= seeds; seed++)
+  {
+    jobs_random(jobs, threads, seed, 0);
+    run_t result;
+    engine_run(jobs, threads, algorithm, 4, &result);
+    for(unsigned int tid = 1; tid <= threads; tid++)
+    {
+      thread_stats_t th;
+      if(thread_stats(tid, &th) == 0)
+      {
+        spread = spread + (th.fairness < 0 ? -th.fairness : th.fairness);
+      }
+    }
+  }
+  free(jobs);
+  return spread / threads / seeds;
+}
+
+//waiting time of a priority 4 thread queued behind a stream of priority 0
+//ones that keeps the CPU busy, aged every AGING ticks
+unsigned int starved_wait(int algorithm, unsigned int aging)
+{
+  job_t jobs[STREAM + 1];
+  jobs[0] = (job_t){ .arrival = 2, .priority = 4, .length = 10 };
+  for(unsigned int i = 1; i <= STREAM; i++)
+  {
+    jobs[i] = (job_t){ .arrival = 4 * (i - 1), .priority = 0, .length = 5 };
+  }
+
+  set_aging(aging);
+  run_t result;
+  thread_stats_t th = { 0 };
+  engine_run(jobs, STREAM + 1, algorithm, 4, &result);
+  thread_stats(1, &th);
+  set_aging(0);
+  return th.waiting_time;
+}
+
+//real-time results of ALGORITHM on THREADS random threads arriving SPACING
+//apart, with their I/O taken out so nothing but the CPU stands between a
+//thread and its deadline
+void deadlines(int algorithm, unsigned int threads, unsigned int spacing, unsigned int seed, rt_stats_t *rt)
+{
+  job_t *jobs = malloc(sizeof(job_t) * threads);
+  jobs_random(jobs, threads, seed, spacing);
+  for(unsigned int i = 0; i < threads; i++)
+  {
+    jobs[i].io_start = 0;
+    jobs[i].io_burst = 0;
+  }
+  run_t result;
+  engine_run(jobs, threads, algorithm, 4, &result);
+  rt_stats(rt);
+  free(jobs);
+}
+
+//the sweep's other checks only hold the scheduler to its own accounting, these
+//hold the policies to what they are for, on one CPU in a context of their own
+void behaviour(unsigned int seeds)
+{
+  context_t *c = context_create();
+  context_use(c);
+  set_cpus(1);
+
+  double cfs = mean_fairness(COMPLETELY_FAIR, 8, seeds);
+  double priority = mean_fairness(PREEMPTIVE_PRIORITY, 8, seeds);
+  expect(cfs < priority, "cfs shares the CPU more fairly than p-priority: deviation %.3f < %.3f", cfs, priority);
+
+  for(int algorithm = NON_PREEMPTIVE_PRIORITY; algorithm <= PREEMPTIVE_PRIORITY; algorithm++)
+  {
+    //an interval no run reaches, since 0 would fall back to SCHED_AGING
+    unsigned int starved = starved_wait(algorithm, UINT_MAX);
+    unsigned int aged = starved_wait(algorithm, STREAM_AGING);
+    expect(aged < starved, "%s aged every %u ticks serves a starved thread sooner: wait %u < %u",
+           algorithm_name(algorithm), STREAM_AGING, aged, starved);
+  }
+
+  //with every thread admitted they never ask for more than the CPU, and EDF
+  //then meets every deadline; RM's bound falls short of the whole CPU
+  unsigned int admitted = 0, misses = 0, edf_rejected = 0, rm_rejected = 0;
+  for(unsigned int seed = 1; seed <= RT_SEEDS; seed++)
+  {
+    rt_stats_t edf, rm;
+    deadlines(EARLIEST_DEADLINE_FIRST, RT_THREADS, RT_SPACING, seed, &edf);
+    deadlines(RATE_MONOTONIC, RT_THREADS, RT_SPACING, seed, &rm);
+    if(edf.rejected == 0)
+    {
+      admitted++;
+      misses = misses + edf.misses;
+    }
+    edf_rejected = edf_rejected + edf.rejected;
+    rm_rejected = rm_rejected + rm.rejected;
+  }
+  expect(admitted > 0 && misses == 0, "edf misses no deadline in %u of %u workloads it admits whole: %u misses",
+         admitted, RT_SEEDS, misses);
+  expect(rm_rejected > edf_rejected, "rm's utilization bound rejects more threads than edf's: %u > %u",
+         rm_rejected, edf_rejected);
+
+  context_destroy(c);
+  engine_free();
+}
+
+void *worker(void *arg)
+{
+  context_t *c = context_create();
+  context_use(c);
+  if(cpus)
+  {
+    set_cpus(cpus);
+  }
+  unsigned int i;
+  while((i = __atomic_fetch_add(&next_run, 1, __ATOMIC_RELAXED)) < run_count)
+  {
+    simulate(&runs[i]);
+  }
+  context_destroy(c);
+  engine_free();
+  return NULL;
+}
+
+double seconds(clockid_t clock)
+{
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+  //it would stand in for every algorithm asked for below
+  if(getenv("SCHED_ALGORITHM") != NULL)
+  {
+    fprintf(stderr, "%s: SCHED_ALGORITHM is set, unset it to run\n", argv[0]);
+    return 2;
+  }
+
+  struct list algorithms = { { FIRST_COME_FIRST_SERVED, ROUND_ROBIN, NON_PREEMPTIVE_PRIORITY,
+                               PREEMPTIVE_PRIORITY, NON_PREEMPTIVE_SHORTEST_JOB_FIRST,
+                               PREEMPTIVE_SHORTEST_JOB_FIRST, NON_PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST,
+                               PREEMPTIVE_SHORTEST_REMAINING_TIME_FIRST, MULTILEVEL_FEEDBACK_QUEUE,
+                               COMPLETELY_FAIR, EARLIEST_DEADLINE_FIRST, RATE_MONOTONIC }, 12 };
+  struct list threads = { { 2, 3, 4, 5, 6, 7, 8, 200 }, 8 };
+  struct list quanta = { { 1, 2, 3, 4 }, 4 };
+  unsigned int seeds = 20;
+  long workers = sysconf(_SC_NPROCESSORS_ONLN);
+  const char *golden = NULL;
+  const char *record = NULL;
+
+  int opt;
+  while((opt = getopt(argc, argv, "a:t:q:s:j:c:g:G:")) != -1)
+  {
+    int bad = 0;
+    switch(opt)
+    {
+      case 'a': bad = parse(optarg, &algorithms, 1); break;
+      case 't': bad = parse(optarg, &threads, 0); break;
+      case 'q': bad = parse(optarg, &quanta, 0); break;
+      case 's': seeds = atoi(optarg); break;
+      case 'j': workers = atoi(optarg); break;
+      case 'c': cpus = atoi(optarg); break;
+      case 'g': golden = optarg; break;
+      case 'G': record = optarg; break;
+      default: bad = -1;
+    }
+    if(bad || seeds == 0 || workers < 1 || (optarg != NULL && opt == 'c' && (cpus < 1 || cpus > MAX_CPUS)))
+    {
+      fprintf(stderr, "usage: %s [-a ALGORITHMS] [-t THREADS] [-q QUANTA] [-s SEEDS] [-j WORKERS] [-c CPUS] "
+              "[-g FILE | -G FILE]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  //each algorithm's runs are consecutive, from first[a] on
+  unsigned int first[MAX_LIST];
+  unsigned int count[MAX_LIST];
+  for(unsigned int a = 0; a < algorithms.size; a++)
+  {
+    first[a] = run_count;
+    count[a] = threads.size * (quantum_sensitive(algorithms.item[a]) ? quanta.size : 1) * seeds;
+    run_count = run_count + count[a];
+  }
+  runs = calloc(run_count, sizeof(struct run));
+  unsigned int n = 0;
+  for(unsigned int a = 0; a < algorithms.size; a++)
+    for(unsigned int t = 0; t < threads.size; t++)
+      for(unsigned int q = 0; q < (quantum_sensitive(algorithms.item[a]) ? quanta.size : 1); q++)
+        for(unsigned int s = 1; s <= seeds; s++)
+        {
+          runs[n++] = (struct run){ algorithms.item[a], threads.item[t], quanta.item[q], s };
+        }
+
+  double wall = seconds(CLOCK_MONOTONIC);
+  double cpu = seconds(CLOCK_PROCESS_CPUTIME_ID);
+  pthread_t pool[workers];
+  for(long w = 0; w < workers; w++)
+  {
+    pthread_create(&pool[w], NULL, worker, NULL);
+  }
+  for(long w = 0; w < workers; w++)
+  {
+    pthread_join(pool[w], NULL);
+  }
+  wall = seconds(CLOCK_MONOTONIC) - wall;
+  cpu = seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+
+  int differ = golden ? check_golden(golden) : 0;
+  if(differ < 0 || (record && write_golden(record) != 0))
+  {
+    return 2;
+  }
+
+  //runs are grouped by algorithm, one row each
+  printf("%-12s %7s %7s %9s %9s %7s %7s %7s %7s %9s %9s %9s %9s %7s\n", "algorithm", "runs", "pass", "turnaround",
+         "waiting", "p99", "max", "fair", "misses", "lateness", "switches", "late",
+         "deferred", "util");
+  unsigned int failed = 0;
+  for(unsigned int a = 0; a < algorithms.size; a++)
+  {
+    unsigned int per = count[a];
+    unsigned int pass = 0;
+    double turnaround = 0, waiting = 0, p99 = 0, longest = 0, fairness = 0, misses = 0, lateness = 0;
+    double switches = 0, late = 0, deferred = 0, utilization = 0;
+    for(unsigned int i = first[a]; i < first[a] + per; i++)
+    {
+      pass = pass + runs[i].pass;
+      turnaround = turnaround + runs[i].turnaround;
+      waiting = waiting + runs[i].waiting;
+      p99 = p99 + runs[i].p99;
+      longest = longest + runs[i].max_waiting;
+      fairness = fairness + runs[i].fairness;
+      misses = misses + runs[i].misses;
+      lateness = lateness + runs[i].lateness;
+      switches = switches + runs[i].switches;
+      late = late + runs[i].late_starts;
+      deferred = deferred + runs[i].deferred;
+      utilization = utilization + runs[i].utilization;
+    }
+    failed = failed + per - pass;
+    printf("%-12s %7u %7u %9.2f %9.2f %7.2f %7.2f %7.3f %7.2f %9.2f %9.2f %9.2f %9.2f %6.1f%%\n",
+           algorithm_name(algorithms.item[a]), per, pass, turnaround / per, waiting / per, p99 / per, longest / per,
+           fairness / per, misses / per, lateness / per, switches / per, late / per, deferred / per,
+           100 * utilization / per);
+
+    if(algorithms.item[a] == MULTILEVEL_FEEDBACK_QUEUE)
+    {
+      for(unsigned int l = 0; l < mlfq_levels() && l < MAX_LEVELS; l++)
+      {
+        double ticks = 0, entries = 0;
+        for(unsigned int i = first[a]; i < first[a] + per; i++)
+        {
+          ticks = ticks + runs[i].level_ticks[l];
+          entries = entries + runs[i].level_entries[l];
+        }
+        printf("  level %u: %.2f ticks, %.2f entries\n", l, ticks / per, entries / per);
+      }
+    }
+  }
+  if(golden)
+  {
+    printf("%d runs differ from %s\n", differ, golden);
+  }
+  printf("%u runs on %ld workers: %.1f ms wall, %.1f ms CPU, %u failed\n",
+         run_count, workers, wall * 1e3, cpu * 1e3, failed);
+
+  behaviour(seeds);
+  return failed || checks_failed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * See workload.h.
+ */
+#include <math.h>
+#include "workload.h"
+
+#define MAX_PRIORITIES 64
+#define MAX_BURST 1000000
+
+void workload_default(workload_t *w)
+{
+  w->burst_mean = 10;
+  w->burst_alpha = 1.5;
+  w->io_fraction = 1.0 / 3;
+  w->io_short = 3;
+  w->io_long = 40;
+  w->io_long_fraction = 0.2;
+  w->load = 0.9;
+  w->group = 4;
+  w->priorities = 5;
+  w->priority_skew = 1.0;
+}
+
+//xorshift64*, uniform in (0, 1]
+static double uniform(unsigned long *state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return ((*state * 2685821657736338717ul) >> 11) * (1.0 / 9007199254740992.0) + 1.0 / 9007199254740992.0;
+}
+
+static double exponential(unsigned long *state, double mean)
+{
+  return -log(uniform(state)) * mean;
+}
+
+//Pareto with the given MEAN and tail ALPHA; the scale is MEAN (ALPHA - 1) / ALPHA
+static double pareto(unsigned long *state, double mean, double alpha)
+{
+  double scale = mean * (alpha - 1) / alpha;
+  return scale / pow(uniform(state), 1.0 / alpha);
+}
+
+//at least one tick, and nothing so long it could overflow the tick counter
+static unsigned int ticks(double x)
+{
+  return x < 1 ? 1 : x > MAX_BURST ? MAX_BURST : (unsigned int)(x + 0.5);
+}
+
+void workload_generate(const workload_t *w, job_t *jobs, unsigned int count, unsigned long seed)
+{
+  unsigned long state = seed * 0x9E3779B97F4A7C15ul + 1;
+
+  //cumulative Zipf weights over the priorities
+  unsigned int levels = w->priorities < 1 ? 1 : w->priorities > MAX_PRIORITIES ? MAX_PRIORITIES : w->priorities;
+  double cdf[MAX_PRIORITIES];
+  double total = 0;
+  for(unsigned int p = 0; p < levels; p++)
+  {
+    total = total + 1.0 / pow(p + 1, w->priority_skew);
+    cdf[p] = total;
+  }
+
+  //groups arrive as a Poisson process slow enough to offer LOAD
+  double group = w->group < 1 ? 1 : w->group;
+  double gap = w->burst_mean * group / (w->load > 0 ? w->load : 1);
+  double clock = 0;
+  unsigned int left = 0;
+
+  for(unsigned int i = 0; i < count; i++)
+  {
+    job_t *j = &jobs[i];
+    if(left == 0)
+    {
+      clock = clock + exponential(&state, gap);
+      left = ticks(exponential(&state, group));
+    }
+    left--;
+    j->arrival = (unsigned int)clock;
+
+    double burst = w->burst_alpha > 1 ? pareto(&state, w->burst_mean, w->burst_alpha)
+                                      : exponential(&state, w->burst_mean);
+    j->length = ticks(burst);
+
+    double u = uniform(&state) * total;
+    unsigned int lo = 0;
+    unsigned int hi = levels - 1;
+    while(lo < hi)
+    {
+      unsigned int mid = (lo + hi) / 2;
+      if(cdf[mid] < u)
+      {
+        lo = mid + 1;
+      }
+      else
+      {
+        hi = mid;
+      }
+    }
+    j->priority = lo;
+
+    j->io_start = 0;
+    j->io_burst = 0;
+    j->write = 0;
+    j->device = 0;
+    if(j->length > 1 && uniform(&state) <= w->io_fraction)
+    {
+      double mean = uniform(&state) <= w->io_long_fraction ? w->io_long : w->io_short;
+      j->io_start = 1 + (unsigned int)(uniform(&state) * (j->length - 1)) % (j->length - 1);
+      j->io_burst = ticks(exponential(&state, mean));
+      j->write = uniform(&state) <= 0.5;
+      j->device = (unsigned int)(uniform(&state) * 65536);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+/**
+ * Synthetic workloads for the stand-in engine, sized anywhere from a few
+ * threads to millions, with the shapes real mixes have and the simulator's
+ * uniform ones lack.
+ */
+#ifndef __WORKLOAD_H
+#define __WORKLOAD_H
+
+#include "engine.h"
+
+typedef struct __workload_t {
+  double burst_mean;             // Mean CPU burst in ticks
+  double burst_alpha;            // Pareto tail of CPU bursts, > 1; 0 for exponential
+  double io_fraction;            // Share of threads that do one I/O
+  double io_short;               // Mean of the short I/O mode
+  double io_long;                // Mean of the long I/O mode
+  double io_long_fraction;       // Share of I/Os in the long mode
+  double load;                   // Offered CPU load, sets the arrival rate
+  double group;                  // Mean arrivals per group, 1 for plain Poisson
+  unsigned int priorities;       // Priorities 0..priorities-1
+  double priority_skew;          // Zipf exponent, priority 0 the most common; 0 for uniform
+} workload_t;
+
+/**
+ * Heavy-tailed bursts (mean 10, alpha 1.5), a third of threads doing I/O
+ * that is short (mean 3) or, one time in five, long (mean 40), 90% load in
+ * groups of 4 arrivals, and five Zipf(1) priorities.
+ */
+void workload_default(workload_t *w);
+
+/**
+ * Fill JOBS with COUNT threads drawn from W, deterministically from SEED.
+ * Arrivals are in non-decreasing order.
+ */
+void workload_generate(const workload_t *w, job_t *jobs, unsigned int count, unsigned long seed);
+
+#endif // __WORKLOAD_H
@@ -0,0 +1,179 @@
+/**
+ * See trace.h for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+//records in the ring, a power of two
+#define TRACE_RING 65536
+
+//how long the consumer sleeps when the ring is empty, and the producer when
+//it is full
+#define TRACE_NAP_NS 50000
+
+//a single producer, single consumer ring: the producer only ever stores
+//HEAD and the consumer TAIL, each on a cache line of its own, and a slot is
+//published by the release store of HEAD past it
+struct trace_writer {
+    FILE *file;
+    pthread_t consumer;
+    unsigned long head __attribute__((aligned(64)));
+    unsigned long tail_seen;
+    unsigned long tail __attribute__((aligned(64)));
+    int closing;
+    trace_record_t ring[TRACE_RING] __attribute__((aligned(64)));
+};
+
+static void nap()
+{
+  struct timespec ts = { 0, TRACE_NAP_NS };
+  nanosleep(&ts, NULL);
+}
+
+//write out whatever the producer has published until it closes
+static void *drain(void *arg)
+{
+  trace_writer_t *w = arg;
+  unsigned long tail = w->tail;
+  for(;;)
+  {
+    int closing = __atomic_load_n(&w->closing, __ATOMIC_ACQUIRE);
+    unsigned long head = __atomic_load_n(&w->head, __ATOMIC_ACQUIRE);
+    if(head == tail)
+    {
+      if(closing)
+      {
+        break;
+      }
+      nap();
+      continue;
+    }
+
+    //at most two runs, the second after the ring wraps
+    while(tail != head)
+    {
+      unsigned long start = tail & (TRACE_RING - 1);
+      unsigned long run = head - tail < TRACE_RING - start ? head - tail : TRACE_RING - start;
+      fwrite(&w->ring[start], sizeof(trace_record_t), run, w->file);
+      tail = tail + run;
+    }
+    __atomic_store_n(&w->tail, tail, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+trace_writer_t *trace_create(const char *path, unsigned int algorithm, unsigned int quantum)
+{
+  FILE *file = fopen(path, "wb");
+  if(file == NULL)
+  {
+    return NULL;
+  }
+
+  trace_header_t header = { TRACE_MAGIC, TRACE_VERSION, algorithm, quantum, sizeof(trace_record_t) };
+  fwrite(&header, sizeof(header), 1, file);
+
+  trace_writer_t *w = aligned_alloc(64, sizeof(trace_writer_t));
+  w->file = file;
+  w->head = 0;
+  w->tail_seen = 0;
+  w->tail = 0;
+  w->closing = 0;
+  if(pthread_create(&w->consumer, NULL, drain, w) != 0)
+  {
+    fclose(file);
+    free(w);
+    return NULL;
+  }
+  return w;
+}
+
+void trace_write(trace_writer_t *w, unsigned int kind, unsigned int time, thread_t *t, unsigned int ready)
+{
+  //the consumer's position is only looked up again when the ring seems full
+  unsigned long head = w->head;
+  while(head - w->tail_seen == TRACE_RING)
+  {
+    w->tail_seen = __atomic_load_n(&w->tail, __ATOMIC_ACQUIRE);
+    if(head - w->tail_seen == TRACE_RING)
+    {
+      nap();
+    }
+  }
+
+  trace_record_t *rec = &w->ring[head & (TRACE_RING - 1)];
+  rec->time = time;
+  rec->tid = t ? t->tid : 0;
+  rec->length = 0;
+  rec->priority = 0;
+  rec->kind = kind;
+  rec->reserved = 0;
+  rec->ready = ready;
+  if(kind == TRACE_EXEC)
+  {
+    rec->length = t->length;
+    rec->priority = t->priority;
+  }
+  __atomic_store_n(&w->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void trace_close(trace_writer_t *w)
+{
+  __atomic_store_n(&w->closing, 1, __ATOMIC_RELEASE);
+  pthread_join(w->consumer, NULL);
+  fclose(w->file);
+  free(w);
+}
+
+int trace_map(const char *path, trace_map_t *map)
+{
+  int fd = open(path, O_RDONLY);
+  if(fd < 0)
+  {
+    return -1;
+  }
+
+  struct stat st;
+  if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(trace_header_t))
+  {
+    close(fd);
+    return -1;
+  }
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(base == MAP_FAILED)
+  {
+    return -1;
+  }
+
+  const trace_header_t *header = base;
+  if(memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0
+     || header->version != TRACE_VERSION
+     || header->record_size != sizeof(trace_record_t))
+  {
+    munmap(base, st.st_size);
+    return -1;
+  }
+
+  //records are read in order exactly once
+  madvise(base, st.st_size, MADV_SEQUENTIAL);
+  map->header = header;
+  map->records = (const trace_record_t *)(header + 1);
+  map->count = (st.st_size - sizeof(trace_header_t)) / sizeof(trace_record_t);
+  map->size = st.st_size;
+  return 0;
+}
+
+void trace_unmap(trace_map_t *map)
+{
+  munmap((void *)map->header, map->size);
+  *map = (trace_map_t){0};
+}
@@ -0,0 +1,96 @@
+/**
+ * Binary callback traces. A trace is a header followed by one fixed-size
+ * record per callback the scheduler received, in order, plus one per
+ * sim_dispatch() it made, so a run can be replayed against the scheduler
+ * without the simulator (see tools/replay.c) and its dispatches checked.
+ * sim_tick() is not recorded; it is implied whenever the time moves on.
+ *
+ * Recording costs the scheduler a store into a lock-free ring; a consumer
+ * thread of the writer's own drains the ring to the file in the background,
+ * and the scheduler only waits if it gets a whole ring ahead.
+ *
+ * All fields are little-endian as written by the recording machine.
+ */
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <stdint.h>
+#include "simulator.h"
+
+#define TRACE_MAGIC "SCHEDTRC"
+#define TRACE_VERSION 2
+
+enum trace_kind {
+  TRACE_EXEC,
+  TRACE_READY,
+  TRACE_READ,
+  TRACE_WRITE,
+  TRACE_EXIT,
+  TRACE_IO_COMPLETE,
+  TRACE_IO_STARTING,
+  TRACE_DISPATCH,                // Made by the scheduler, TID 0 for none
+  TRACE_KINDS
+};
+
+typedef struct __trace_header_t {
+  char magic[8];
+  uint32_t version;
+  uint32_t algorithm;            // As passed to scheduler()
+  uint32_t quantum;
+  uint32_t record_size;
+} trace_header_t;
+
+typedef struct __trace_record_t {
+  uint32_t time;                 // sim_time() at the callback
+  uint32_t tid;
+  uint32_t length;               // TRACE_EXEC only, thread_t::length
+  uint16_t priority;             // TRACE_EXEC only, thread_t::priority
+  uint8_t kind;
+  uint8_t reserved;
+  uint32_t ready;                // Threads ready but not running when it happened
+} trace_record_t;
+
+/**
+ * Record the next simulation, from scheduler() to stats(), to the file at
+ * PATH; NULL stops recording. Without a call the SCHED_TRACE environment
+ * variable is used.
+ */
+void set_trace(const char *path);
+
+typedef struct trace_writer trace_writer_t;
+
+/**
+ * Create PATH and write a header for ALGORITHM and QUANTUM, or return NULL.
+ */
+trace_writer_t *trace_create(const char *path, unsigned int algorithm, unsigned int quantum);
+
+/**
+ * Append a KIND record at TIME for T, which may be NULL, with READY threads
+ * waiting to run. Only one OS thread may write to W.
+ */
+void trace_write(trace_writer_t *w, unsigned int kind, unsigned int time, thread_t *t, unsigned int ready);
+
+/**
+ * Wait for the consumer to drain W, then close it.
+ */
+void trace_close(trace_writer_t *w);
+
+/**
+ * A trace file mapped read-only into memory.
+ */
+typedef struct __trace_map_t {
+  const trace_header_t *header;
+  const trace_record_t *records;
+  unsigned long count;
+  unsigned long size;            // Bytes mapped
+} trace_map_t;
+
+/**
+ * Map the trace at PATH into MAP and return 0, or return -1 if it cannot be
+ * opened or is not a trace this version understands.
+ */
+int trace_map(const char *path, trace_map_t *map);
+
+void trace_unmap(trace_map_t *map);
+
+#endif // __TRACE_H